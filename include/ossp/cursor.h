@@ -0,0 +1,133 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <bytebuffer/ByteBuffer.h>
+#include <array>
+#include <string_view>
+#include "ossp.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+enum class CursorEvent : uint8_t {
+    Nil = 0,
+    Bool,
+    Int,
+    Float,
+    String,
+    Symbol,
+    BeginHash,    // followed by size keys and values, tables are reported as Hashes
+    BeginArray,   // followed by size values
+    Float64Array, // size elements in block
+    Int64Array,   // size elements in block
+    End           // the current Hash or Array (or at the top level the whole value) is done
+};
+
+struct CursorValue {
+    CursorEvent event;
+    bool key; // true for the keys of a Hash
+    bool boolean;
+    int64_t integer;
+    double number;
+    std::string_view string; // points into the read data
+    uint32_t size;
+    const uint8_t* block; // typed array elements in the byte order of the data
+    uint32_t layout; // TableLayouts id if BeginHash started a table, otherwise 0
+};
+
+// Pull reader over encoded data that never allocates and needs no mrb_state.
+// Every call to Next returns the next key or value in document order:
+//
+//     auto cursor = Cursor::Open(rb);
+//     auto entries = cursor->EnterHash();
+//     if (entries && cursor->FindKey("name").value_or(false)) {
+//         auto name = cursor->Next(); // name->string
+//     }
+//
+// The cursor only views the data, which has to outlive it and all returned string_views.
+// Data with other FLAGS than the Options is rejected; dispatch_OSSP_features picks the right cursor.
+template <typename Options>
+class BasicCursor {
+public:
+    static constexpr Endianness endian = Options::endian;
+
+    static tl::expected<BasicCursor, OSSPErrorInfo> Open(ReadBuffer* rb);
+
+    static tl::expected<BasicCursor, OSSPErrorInfo> Open(const uint8_t* data, size_t size);
+
+    tl::expected<CursorValue, OSSPErrorInfo> Next();
+
+    // skips the next key or value including all of its children
+    tl::expected<void, OSSPErrorInfo> SkipValue();
+
+    // expects the next value to be a Hash and returns its size
+    tl::expected<st_counter_t, OSSPErrorInfo> EnterHash();
+
+    tl::expected<st_counter_t, OSSPErrorInfo> EnterArray();
+
+    // Searches the remaining entries of the current Hash for a String or Symbol key.
+    // If found, the cursor stands in front of its value. Otherwise the Hash is exhausted and
+    // the next event is its End.
+    tl::expected<bool, OSSPErrorInfo> FindKey(std::string_view key);
+
+    // Moves to the key of entry index of the current table in O(1), the index being the position of
+    // the key in its layout. The remaining entries follow as usual. Any entry can be sought in any order
+    // until the End of the table was read.
+    tl::expected<void, OSSPErrorInfo> SeekField(st_counter_t index);
+
+    // copies the block of a typed array in host byte order to out, which holds value.size elements
+    void CopyBlock(const CursorValue& value, void* out) const;
+
+    // empty if the data has no meta data
+    std::string_view MetaData() const;
+
+    uint16_t Depth() const;
+
+    // reading position in the data, for error messages
+    size_t Position() const;
+
+private:
+    struct Frame {
+        uint32_t remaining; // hashes count keys and values separately
+        bool hash;
+        OSSPTable table; // position 0 for everything but tables, the header comes first
+    };
+
+    BasicCursor(SpanReader sr, std::string_view meta_data);
+
+    // returns the frame of the next value or nullptr if the current container is done
+    Frame* Current();
+
+    tl::expected<void, OSSPErrorInfo> Push(bool hash, uint32_t remaining, const OSSPTable& table = {});
+
+    SpanReader m_sr;
+    std::string_view m_meta_data;
+    std::array<Frame, Options::max_depth + 1> m_frames;
+    uint16_t m_depth;
+};
+
+using Cursor = BasicCursor<DefaultOptions>;
+
+}
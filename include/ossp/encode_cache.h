@@ -0,0 +1,103 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "../mruby.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lyniat::ossp::serialize::bin {
+
+struct EncodeOptions;
+
+// Opt-in cache for the encoding of frozen Hashes and Arrays, set in EncodeOptions::cache.
+// A container is stored once it and everything in it is frozen (Strings and containers) or immutable
+// (nil, booleans, numbers, Symbols), so its bytes can not change while it exists. Later calls of
+// Serialize with the same features and options append these bytes instead of walking it again.
+// A container that is only frozen itself never hits: it is encoded as usual on every call and counted
+// as a miss each time, only the deep frozen containers inside it are cached.
+//
+// Entries are keyed by object identity. mRuby has no free hook for Hashes and the address of a
+// collected one can be taken by a new frozen Hash, so instead of watching its objects the cache keeps
+// them alive: Sweep drops every entry that was not used since max_idle sweeps and leaves its object
+// to the GC. Slots are direct mapped by address, a colliding container replaces the old one.
+// The cache has to be destroyed before mrb_close.
+class EncodeCache {
+public:
+    explicit EncodeCache(mrb_state* mrb, size_t capacity = 256, uint32_t max_idle = 60);
+
+    ~EncodeCache();
+
+    EncodeCache(const EncodeCache&) = delete;
+
+    EncodeCache& operator=(const EncodeCache&) = delete;
+
+    // call once per tick or broadcast
+    void Sweep();
+
+    void Clear();
+
+    size_t Size() const;
+
+    size_t Hits() const;
+
+    size_t Misses() const;
+
+    // true for frozen Hashes and Arrays, the only values the encoder looks up
+    static bool IsCandidate(mrb_value value);
+
+    // the stored bytes of container if they were encoded with features and options, otherwise nullptr
+    const std::vector<uint8_t>* Find(mrb_value container, uint64_t features, const EncodeOptions& options);
+
+    void Store(mrb_value container, uint64_t features, const EncodeOptions& options, const uint8_t* bytes,
+               size_t size);
+
+private:
+    struct Entry {
+        uint64_t features;
+        const void* records;
+        const void* tables;
+        uint32_t last_used;
+        std::vector<uint8_t> bytes;
+    };
+
+    size_t Slot(mrb_value container) const;
+
+    void Drop(size_t slot);
+
+    mrb_state* m_mrb;
+    // keeps the cached containers alive, nil for empty slots
+    mrb_value m_objects;
+    std::vector<Entry> m_entries;
+    uint32_t m_max_idle;
+    uint32_t m_sweeps = 0;
+    size_t m_size = 0;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+};
+
+}
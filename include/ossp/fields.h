@@ -0,0 +1,393 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "cursor.h"
+#include "writer.h"
+
+// Declares the fields of a struct for direct encoding and decoding without mRuby:
+//
+//     struct Player { int64_t id; std::string name; std::vector<double> pos; int hp; };
+//     OSSP_FIELDS(Player, id, name, pos, hp)
+//
+//     auto written = Encode(player, bb);   // a Hash with the Symbol keys :id, :name, :pos and :hp
+//     auto read = Decode(rb, player);
+//
+// Has to be used in the global namespace with the fully qualified type name. Supports up to 32 fields.
+#define OSSP_FIELDS(Type, ...)                                                                           \
+    template <>                                                                                          \
+    struct lyniat::ossp::serialize::bin::OSSPFields<Type> {                                              \
+        static constexpr bool defined = true;                                                            \
+        using type = Type;                                                                               \
+        static constexpr std::array<std::string_view, OSSP_COUNT_ARGS(__VA_ARGS__)> names = {            \
+            OSSP_FOR_EACH(OSSP_FIELD_NAME, __VA_ARGS__)};                                                \
+        static constexpr auto members = std::make_tuple(OSSP_FOR_EACH(OSSP_FIELD_MEMBER, __VA_ARGS__)); \
+    };
+
+#define OSSP_FIELD_NAME(field) std::string_view(#field)
+#define OSSP_FIELD_MEMBER(field) &type::field
+
+#define OSSP_EXPAND(x) x
+#define OSSP_COUNT_ARGS(...) OSSP_EXPAND(OSSP_COUNT_ARGS_IMPL(__VA_ARGS__, \
+    32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,        \
+    16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define OSSP_COUNT_ARGS_IMPL(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+    _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+
+#define OSSP_CONCAT(a, b) OSSP_CONCAT_IMPL(a, b)
+#define OSSP_CONCAT_IMPL(a, b) a##b
+#define OSSP_FOR_EACH(f, ...) OSSP_EXPAND(OSSP_CONCAT(OSSP_FOR_EACH_, OSSP_COUNT_ARGS(__VA_ARGS__))(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_1(f, x) f(x)
+#define OSSP_FOR_EACH_2(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_1(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_3(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_2(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_4(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_3(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_5(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_4(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_6(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_5(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_7(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_6(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_8(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_7(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_9(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_8(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_10(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_9(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_11(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_10(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_12(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_11(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_13(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_12(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_14(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_13(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_15(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_14(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_16(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_15(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_17(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_16(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_18(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_17(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_19(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_18(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_20(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_19(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_21(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_20(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_22(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_21(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_23(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_22(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_24(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_23(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_25(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_24(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_26(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_25(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_27(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_26(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_28(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_27(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_29(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_28(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_30(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_29(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_31(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_30(f, __VA_ARGS__))
+#define OSSP_FOR_EACH_32(f, x, ...) f(x), OSSP_EXPAND(OSSP_FOR_EACH_31(f, __VA_ARGS__))
+
+namespace lyniat::ossp::serialize::bin {
+
+// A Symbol key with type byte and length, ready to be appended
+struct EncodedFieldKey {
+    static constexpr size_t max_length = 61;
+
+    uint8_t bytes[max_length + 3];
+    size_t size;
+};
+
+template <Endianness E>
+constexpr EncodedFieldKey encode_OSSP_field_key(std::string_view name) {
+    EncodedFieldKey key = {};
+    auto length = (st_counter_t)name.size();
+    key.bytes[0] = ST_SYMBOL;
+    key.bytes[1] = E == Big ? length >> 8 : length & 0xFF;
+    key.bytes[2] = E == Big ? length & 0xFF : length >> 8;
+    for (size_t i = 0; i < name.size(); i++) {
+        key.bytes[i + 3] = (uint8_t)name[i];
+    }
+    key.size = name.size() + 3;
+    return key;
+}
+
+constexpr uint32_t hash_OSSP_field_name(std::string_view name, uint32_t seed) {
+    // FNV-1a with a seeded basis
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : name) {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Collision free table from hashed field names to field indices, searched for at compile time.
+template <size_t N>
+struct FieldTable {
+    static constexpr size_t capacity = [] {
+        size_t capacity = 1;
+        while (capacity < N * 2) {
+            capacity *= 2;
+        }
+        return capacity;
+    }();
+
+    uint32_t seed;
+    std::array<int16_t, capacity> slots;
+
+    static constexpr FieldTable Create(const std::array<std::string_view, N>& names) {
+        FieldTable table = {};
+        for (uint32_t seed = 0;; seed++) {
+            table.seed = seed;
+            for (auto& slot : table.slots) {
+                slot = -1;
+            }
+            bool perfect = true;
+            for (size_t i = 0; i < N && perfect; i++) {
+                auto& slot = table.slots[hash_OSSP_field_name(names[i], seed) & (capacity - 1)];
+                perfect = slot < 0;
+                slot = (int16_t)i;
+            }
+            if (perfect) {
+                return table;
+            }
+        }
+    }
+
+    // returns the index of name or -1
+    constexpr int Find(const std::array<std::string_view, N>& names, std::string_view name) const {
+        auto index = slots[hash_OSSP_field_name(name, seed) & (capacity - 1)];
+        return index >= 0 && names[index] == name ? index : -1;
+    }
+};
+
+template <typename T>
+struct FieldCodec {
+    using Fields = OSSPFields<T>;
+
+    static constexpr size_t count = Fields::names.size();
+
+    static constexpr FieldTable<count> table = FieldTable<count>::Create(Fields::names);
+
+    template <Endianness E>
+    static constexpr std::array<EncodedFieldKey, count> EncodedKeys() {
+        std::array<EncodedFieldKey, count> keys = {};
+        for (size_t i = 0; i < count; i++) {
+            keys[i] = encode_OSSP_field_key<E>(Fields::names[i]);
+        }
+        return keys;
+    }
+
+    template <Endianness E>
+    static constexpr std::array<EncodedFieldKey, count> keys = EncodedKeys<E>();
+
+    static_assert([] {
+        for (auto name : Fields::names) {
+            if (name.size() > EncodedFieldKey::max_length) {
+                return false;
+            }
+        }
+        return true;
+    }(), "OSSP_FIELDS names are limited to 61 characters");
+
+    template <typename Options, size_t... I>
+    static void Write(BasicWriter<Options>& writer, const T& value, std::index_sequence<I...>) {
+        constexpr auto& encoded = keys<Options::endian>;
+        writer.BeginHash((st_counter_t)count);
+        ((writer.EncodedKey(encoded[I].bytes, encoded[I].size), writer.Write(value.*std::get<I>(Fields::members))), ...);
+    }
+
+    // reads the value of the field index into value, unknown fields are skipped
+    template <typename Options, size_t... I>
+    static tl::expected<void, OSSPErrorInfo> ReadField(BasicCursor<Options>& cursor, int index, T& value,
+                                                       std::index_sequence<I...>) {
+        tl::expected<void, OSSPErrorInfo> result;
+        bool known = ((index == (int)I ? (result = read_OSSP_field(cursor, value.*std::get<I>(Fields::members)), true)
+                                       : false) || ...);
+        if (!known) {
+            return cursor.SkipValue();
+        }
+        return result;
+    }
+};
+
+template <typename Options, typename T>
+tl::expected<void, OSSPErrorInfo> read_OSSP_value(BasicCursor<Options>& cursor, const CursorValue& current, T& out);
+
+// reads the next value of cursor into out
+template <typename Options, typename T>
+tl::expected<void, OSSPErrorInfo> read_OSSP_field(BasicCursor<Options>& cursor, T& out) {
+    auto current = cursor.Next();
+    if (!current) {
+        return tl::unexpected(current.error());
+    }
+    return read_OSSP_value(cursor, current.value(), out);
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> read_OSSP_end(BasicCursor<Options>& cursor) {
+    auto end = cursor.Next();
+    if (!end) {
+        return tl::unexpected(end.error());
+    }
+    if (end->event != CursorEvent::End) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, cursor.Position());
+    }
+    return {};
+}
+
+// whether value can be stored in T without changing it
+template <typename T>
+constexpr bool fits_OSSP_integer(int64_t value) {
+    if constexpr (std::is_unsigned_v<T>) {
+        return value >= 0 && (uint64_t)value <= std::numeric_limits<T>::max();
+    } else {
+        return value >= std::numeric_limits<T>::min() && value <= std::numeric_limits<T>::max();
+    }
+}
+
+template <typename Options, typename T>
+tl::expected<void, OSSPErrorInfo> read_OSSP_value(BasicCursor<Options>& cursor, const CursorValue& current, T& out) {
+    // built only when it is returned, make_OSSP_error allocates
+    auto mismatch = [&cursor]() { return make_OSSP_error(OSSPErrorInfoInvalidType, cursor.Position()); };
+    if constexpr (std::is_same_v<T, bool>) {
+        if (current.event != CursorEvent::Bool) {
+            return mismatch();
+        }
+        out = current.boolean;
+    } else if constexpr (std::is_integral_v<T>) {
+        if (current.event != CursorEvent::Int || !fits_OSSP_integer<T>(current.integer)) {
+            return mismatch();
+        }
+        out = (T)current.integer;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        if (current.event == CursorEvent::Float) {
+            out = (T)current.number;
+        } else if (current.event == CursorEvent::Int) {
+            out = (T)current.integer;
+        } else {
+            return mismatch();
+        }
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        if (current.event != CursorEvent::String && current.event != CursorEvent::Symbol) {
+            return mismatch();
+        }
+        out.assign(current.string.data(), current.string.size());
+    } else if constexpr (OSSPFields<T>::defined) {
+        if (current.event != CursorEvent::BeginHash) {
+            return mismatch();
+        }
+        using Codec = FieldCodec<T>;
+        for (uint32_t i = 0; i < current.size; i++) {
+            auto key = cursor.Next();
+            if (!key) {
+                return tl::unexpected(key.error());
+            }
+            int index = -1;
+            if (key->event == CursorEvent::String || key->event == CursorEvent::Symbol) {
+                index = Codec::table.Find(OSSPFields<T>::names, key->string);
+            }
+            auto read = Codec::ReadField(cursor, index, out, std::make_index_sequence<Codec::count>());
+            if (!read) {
+                return read;
+            }
+        }
+        return read_OSSP_end(cursor);
+    } else if constexpr (IsStdOptional<T>::value) {
+        if (current.event == CursorEvent::Nil) {
+            out.reset();
+            return {};
+        }
+        typename T::value_type value{};
+        auto read = read_OSSP_value(cursor, current, value);
+        if (read) {
+            out = std::move(value);
+        }
+        return read;
+    } else if constexpr (IsStdVector<T>::value) {
+        using Element = typename T::value_type;
+        if constexpr (std::is_same_v<Element, double> || std::is_same_v<Element, int64_t>) {
+            constexpr auto block_event = std::is_same_v<Element, double> ? CursorEvent::Float64Array
+                                                                         : CursorEvent::Int64Array;
+            if (current.event == block_event) {
+                out.resize(current.size);
+                cursor.CopyBlock(current, out.data());
+                return {};
+            }
+        }
+        if (current.event != CursorEvent::BeginArray) {
+            return mismatch();
+        }
+        out.resize(current.size);
+        // by index through a temporary, std::vector<bool> has no references to its elements
+        for (size_t i = 0; i < out.size(); i++) {
+            Element element{};
+            auto read = read_OSSP_field(cursor, element);
+            if (!read) {
+                return read;
+            }
+            out[i] = std::move(element);
+        }
+        return read_OSSP_end(cursor);
+    } else if constexpr (IsStdMap<T>::value) {
+        if (current.event != CursorEvent::BeginHash) {
+            return mismatch();
+        }
+        out.clear();
+        for (uint32_t i = 0; i < current.size; i++) {
+            typename T::key_type key{};
+            auto read = read_OSSP_field(cursor, key);
+            if (read) {
+                read = read_OSSP_field(cursor, out[key]);
+            }
+            if (!read) {
+                return read;
+            }
+        }
+        return read_OSSP_end(cursor);
+    } else {
+        static_assert(!sizeof(T), "type can not be read from OSSP");
+    }
+    return {};
+}
+
+template <typename Options, typename T>
+void write_OSSP_fields(BasicWriter<Options>& writer, const T& value) {
+    FieldCodec<T>::Write(writer, value, std::make_index_sequence<FieldCodec<T>::count>());
+}
+
+// Encodes value, whose type was declared with OSSP_FIELDS, into the empty buffer bb.
+template <typename Options = DefaultOptions, typename T>
+std::enable_if_t<OSSPFields<T>::defined, tl::expected<void, OSSPErrorInfo>>
+Encode(const T& value, ByteBuffer& bb, const std::string& meta_data = "") {
+    BasicWriter<Options> writer(&bb);
+    writer.Write(value);
+    return writer.Finish(meta_data);
+}
+
+// Decodes into value, whose type was declared with OSSP_FIELDS. Fields missing in the data keep
+// their value, unknown keys are skipped.
+template <typename Options = DefaultOptions, typename T>
+std::enable_if_t<OSSPFields<T>::defined, tl::expected<void, OSSPErrorInfo>>
+Decode(ReadBuffer& rb, T& value) {
+    auto cursor = BasicCursor<Options>::Open(&rb);
+    if (!cursor) {
+        return tl::unexpected(cursor.error());
+    }
+    return read_OSSP_field(cursor.value(), value);
+}
+
+}
@@ -0,0 +1,49 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+
+namespace lyniat::ossp::serialize::bin {
+
+// Sign, 17 digits, the decimal point and "e-308" fit with room to spare.
+constexpr size_t float_text_max_size = 32;
+
+// Writes the shortest decimal text that reads back as exactly value (Grisu2 with 64 bit arithmetic,
+// for a tiny fraction of values one digit longer than the shortest). Integral values keep a ".0",
+// magnitudes from 1e15 and below 1e-4 use exponent notation ("1.5e+300"). NaN and the infinities
+// become nan, inf and -inf, formats without them have to check first.
+// buffer needs float_text_max_size bytes, the text is not terminated. Returns its end.
+char* format_float(double value, char* buffer);
+
+// Parses -?digits[.digits][(e|E)[+-]digits] from [first, last) into the correctly rounded double.
+// Either side of the decimal point may be empty, but not both. Up to 19 significant digits are
+// handled with the Clinger fast path or Eisel-Lemire, longer ones fall back to strtod when the
+// dropped digits could change the result.
+// Returns the end of the number or nullptr if first does not start one.
+const char* parse_float(const char* first, const char* last, double* value);
+
+}
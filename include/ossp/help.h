@@ -46,11 +46,14 @@
 #define mrb_string_cstr API->mrb_string_cstr
 #define mrb_obj_to_sym API->mrb_obj_to_sym
 #define mrb_str_new API->mrb_str_new
+#define mrb_str_byte_subseq API->mrb_str_byte_subseq
 #define mrb_to_flo API->mrb_to_flo
 #define mrb_to_int API->mrb_to_int
 #define mrb_intern_check_cstr API->mrb_intern_check_cstr
 #define mrb_intern_cstr API->mrb_intern_cstr
 #define mrb_intern_str API->mrb_intern_str
+#define mrb_intern API->mrb_intern
+#define mrb_sym_name_len API->mrb_sym_name_len
 #define mrb_symbol_value API->mrb_symbol_value
 #define mrb_ary_new_capa API->mrb_ary_new_capa
 #define mrb_ary_set API->mrb_ary_set
@@ -78,6 +81,25 @@
 #define mrb_intern_static API->mrb_intern_static
 #define mrb_obj_new API->mrb_obj_new
 #define mrb_class_new_instance API->mrb_class_new_instance
+#define mrb_obj_freeze API->mrb_obj_freeze
+#define mrb_gc_register API->mrb_gc_register
+#define mrb_gc_unregister API->mrb_gc_unregister
+#define mrb_obj_alloc API->mrb_obj_alloc
+#define mrb_iv_get API->mrb_iv_get
+#define mrb_iv_set API->mrb_iv_set
+#define mrb_define_module API->mrb_define_module
+#define mrb_define_class_under API->mrb_define_class_under
+#define mrb_define_method API->mrb_define_method
+#define mrb_class_defined API->mrb_class_defined
+#define mrb_class_defined_under API->mrb_class_defined_under
+#define mrb_data_object_alloc API->mrb_data_object_alloc
+#define mrb_yield API->mrb_yield
+#define mrb_hash_key_p API->mrb_hash_key_p
+#define mrb_hash_delete_key API->mrb_hash_delete_key
+#define mrb_hash_keys API->mrb_hash_keys
+#define mrb_ary_push API->mrb_ary_push
+#define mrb_ary_pop API->mrb_ary_pop
+#define mrb_ary_resize API->mrb_ary_resize
 #else
 #define mrb_hash_set mrb_hash_set
 #define mrb_hash_get mrb_hash_get
@@ -92,11 +114,14 @@
 #define mrb_string_cstr mrb_string_cstr
 #define mrb_obj_to_sym mrb_obj_to_sym
 #define mrb_str_new mrb_str_new
+#define mrb_str_byte_subseq mrb_str_byte_subseq
 #define mrb_to_flo mrb_to_flo
 #define mrb_to_int mrb_to_int
 #define mrb_intern_check_cstr mrb_intern_check_cstr
 #define mrb_intern_cstr mrb_intern_cstr
 #define mrb_intern_str mrb_intern_str
+#define mrb_intern mrb_intern
+#define mrb_sym_name_len mrb_sym_name_len
 #define mrb_symbol_value mrb_symbol_value
 #define mrb_ary_new_capa mrb_ary_new_capa
 #define mrb_ary_set mrb_ary_set
@@ -124,6 +149,25 @@
 #define mrb_intern_static mrb_intern_static
 #define mrb_obj_new mrb_obj_new
 #define mrb_class_new_instance mrb_class_new_instance
+#define mrb_obj_freeze mrb_obj_freeze
+#define mrb_gc_register mrb_gc_register
+#define mrb_gc_unregister mrb_gc_unregister
+#define mrb_obj_alloc mrb_obj_alloc
+#define mrb_iv_get mrb_iv_get
+#define mrb_iv_set mrb_iv_set
+#define mrb_define_module mrb_define_module
+#define mrb_define_class_under mrb_define_class_under
+#define mrb_define_method mrb_define_method
+#define mrb_class_defined mrb_class_defined
+#define mrb_class_defined_under mrb_class_defined_under
+#define mrb_data_object_alloc mrb_data_object_alloc
+#define mrb_yield mrb_yield
+#define mrb_hash_key_p mrb_hash_key_p
+#define mrb_hash_delete_key mrb_hash_delete_key
+#define mrb_hash_keys mrb_hash_keys
+#define mrb_ary_push mrb_ary_push
+#define mrb_ary_pop mrb_ary_pop
+#define mrb_ary_resize mrb_ary_resize
 #endif
 
 mrb_int cext_to_int(mrb_state* mrb, mrb_value value);
@@ -0,0 +1,144 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <bytebuffer/ByteBuffer.h>
+#include <array>
+#include <string>
+#include <string_view>
+#include "cursor.h"
+#include "ossp.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+// Returns the index of the first byte in data that can not be copied into a JSON string as is
+// ('"', '\\' or a control character) or size if there is none. Scans 16 bytes at a time with SSE2,
+// otherwise 8 bytes at a time in a 64 bit word.
+size_t find_JSON_special(const char* data, size_t size);
+
+// Rejects truncated sequences, overlong encodings, surrogates and code points above U+10FFFF.
+// ASCII is skipped 16 bytes at a time with SSE2, otherwise 8 bytes at a time.
+bool is_valid_UTF8(const char* data, size_t size);
+
+// appends data as a quoted JSON string, bytes of 0x80 and above are passed through unchanged
+void append_JSON_string(ByteBuffer* bb, std::string_view data);
+
+void append_JSON_int(ByteBuffer* bb, int64_t value);
+
+// Appends value so it reads back as a float (1.0 instead of 1).
+// JSON has no NaN and Infinity, they become null.
+void append_JSON_float(ByteBuffer* bb, double value);
+
+// Pull parser for JSON text, reporting the events of BasicCursor so both can feed the same code:
+// objects are BeginHash with String keys, arrays BeginArray, each closed by End.
+// JSON does not announce sizes, so CursorValue::size stays 0.
+// Strings without escapes point into the data, others into a buffer that is reused by the next call.
+class JSONReader {
+public:
+    static constexpr uint16_t max_depth = DefaultOptions::max_depth;
+
+    JSONReader(const uint8_t* data, size_t size);
+
+    explicit JSONReader(ReadBuffer* rb);
+
+    tl::expected<CursorValue, OSSPErrorInfo> Next();
+
+    // skips the next value including all of its children
+    tl::expected<void, OSSPErrorInfo> SkipValue();
+
+    uint16_t Depth() const;
+
+    size_t Position() const;
+
+private:
+    enum class State : uint8_t {
+        First, // nothing read yet
+        Key,   // an object expects its next key
+        Value, // a value follows
+        Done   // a value was read, a separator or the end follows
+    };
+
+    struct Frame {
+        bool object;
+        State state;
+    };
+
+    void SkipWhitespace();
+
+    // reads the next value, the container frames are already set up for it
+    tl::expected<CursorValue, OSSPErrorInfo> ReadValue(CursorValue value);
+
+    tl::expected<std::string_view, OSSPErrorInfo> ReadString();
+
+    tl::expected<void, OSSPErrorInfo> ReadNumber(CursorValue* value);
+
+    bool ReadLiteral(std::string_view literal);
+
+    // appends the UTF-8 encoding of the \u escape at the reading position to m_scratch
+    bool ReadUnicodeEscape();
+
+    SpanReader m_sr;
+    std::string m_scratch;
+    std::array<Frame, max_depth + 1> m_frames;
+    uint16_t m_depth;
+};
+
+// mRuby values <-> JSON text. Walks the values like BasicOSSP does and writes into the same ByteBuffer:
+//
+//     JSON::Serialize(bb, mrb, data);
+//     auto data = JSON::Deserialize(bb, mrb, options);
+//
+// Symbols and Strings both become JSON strings, Integer and Float Hash keys are written as strings.
+// Values JSON has no representation for are written as null.
+class JSON {
+public:
+    JSON() = delete;
+
+    ~JSON() = delete;
+
+    static constexpr uint16_t max_depth = DefaultOptions::max_depth;
+
+    static void Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options = {});
+
+    // reads one JSON value, only whitespace may follow
+    static tl::expected<mrb_value, OSSPErrorInfo> Deserialize(ReadBuffer* rb, mrb_state* mrb,
+                                                              const DecodeOptions& options = {});
+
+private:
+    static void SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options);
+
+    // key has to be a String, Symbol, Integer or Float, entries with other keys are left out
+    static void AddKey(ByteBuffer* bb, mrb_state* mrb, mrb_value key);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeValue(JSONReader* reader, const CursorValue& value,
+                                                              mrb_state* mrb, const DecodeOptions& options);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeObject(JSONReader* reader, mrb_state* mrb,
+                                                               const DecodeOptions& options);
+
+    static mrb_value DecodeString(std::string_view string, mrb_state* mrb, const DecodeOptions& options);
+};
+
+}
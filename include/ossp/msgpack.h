@@ -0,0 +1,135 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <bytebuffer/ByteBuffer.h>
+#include <array>
+#include <string_view>
+#include "cursor.h"
+#include "ossp.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+// Ext type of Symbols, the payload is the name. Strings are str, so both survive a round trip.
+constexpr int8_t MSGPACK_SYMBOL_EXT = 0;
+
+// Append single MessagePack values. Integers use the smallest form that holds them,
+// Floats are always float 64 so they read back exactly.
+void append_MessagePack_nil(ByteBuffer* bb);
+
+void append_MessagePack_bool(ByteBuffer* bb, bool value);
+
+void append_MessagePack_int(ByteBuffer* bb, int64_t value);
+
+void append_MessagePack_float(ByteBuffer* bb, double value);
+
+void append_MessagePack_string(ByteBuffer* bb, std::string_view value);
+
+void append_MessagePack_symbol(ByteBuffer* bb, std::string_view name);
+
+// followed by size values
+void append_MessagePack_array(ByteBuffer* bb, uint32_t size);
+
+// followed by size keys and values
+void append_MessagePack_map(ByteBuffer* bb, uint32_t size);
+
+// Pull parser for MessagePack, reporting the events of BasicCursor so both can feed the same code:
+// maps are BeginHash, arrays BeginArray, each with its size and closed by End.
+// str and bin are String, the symbol ext type Symbol. Integers above INT64_MAX become Float
+// as mRuby has no Bignum. Other ext types are rejected with InvalidType.
+// Strings point into the data, which has to outlive the reader.
+class MessagePackReader {
+public:
+    static constexpr uint16_t max_depth = DefaultOptions::max_depth;
+
+    MessagePackReader(const uint8_t* data, size_t size);
+
+    explicit MessagePackReader(ReadBuffer* rb);
+
+    tl::expected<CursorValue, OSSPErrorInfo> Next();
+
+    uint16_t Depth() const;
+
+    // reading position in the data, after the final End that of the first byte behind the value
+    size_t Position() const;
+
+private:
+    struct Frame {
+        uint64_t remaining; // maps count keys and values separately
+        bool map;
+    };
+
+    tl::expected<CursorValue, OSSPErrorInfo> ReadValue(CursorValue value);
+
+    // reads a big endian length of 1, 2 or 4 bytes
+    bool ReadLength(uint8_t size, uint32_t* length);
+
+    bool ReadBytes(uint32_t length, std::string_view* bytes);
+
+    tl::expected<CursorValue, OSSPErrorInfo> BeginContainer(CursorValue value, bool map, uint32_t size);
+
+    // ext of length bytes, the type byte follows
+    tl::expected<CursorValue, OSSPErrorInfo> ReadExt(CursorValue value, uint32_t length);
+
+    SpanReader m_sr;
+    std::array<Frame, max_depth> m_frames;
+    uint16_t m_depth;
+    bool m_done;
+};
+
+// mRuby values <-> MessagePack. Walks the values like BasicOSSP does and writes into the same ByteBuffer:
+//
+//     MessagePack::Serialize(bb, mrb, data);
+//     auto data = MessagePack::Deserialize(bb, mrb, options);
+//
+// Typed arrays become arrays, values MessagePack has no representation for are written as nil.
+class MessagePack {
+public:
+    MessagePack() = delete;
+
+    ~MessagePack() = delete;
+
+    static constexpr uint16_t max_depth = DefaultOptions::max_depth;
+
+    static void Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options = {});
+
+    // reads one MessagePack value, nothing may follow
+    static tl::expected<mrb_value, OSSPErrorInfo> Deserialize(ReadBuffer* rb, mrb_state* mrb,
+                                                              const DecodeOptions& options = {});
+
+private:
+    static void SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeValue(MessagePackReader* reader, const CursorValue& value,
+                                                              mrb_state* mrb, const DecodeOptions& options);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeMap(MessagePackReader* reader, const CursorValue& value,
+                                                            mrb_state* mrb, const DecodeOptions& options);
+
+    static mrb_value DecodeString(std::string_view string, mrb_state* mrb, const DecodeOptions& options);
+};
+
+}
@@ -1,16 +1,86 @@
 #pragma once
 
 #include <bytebuffer/ByteBuffer.h>
+#include <array>
 #include <sstream>
+#include <string_view>
+#include <vector>
 #include "../mruby.h"
+#include "reader.h"
 #include "serialize.h"
+#include "encode_cache.h"
+#include "patch.h"
+#include "record_table.h"
+#include "string_table.h"
+#include "table_layouts.h"
+#include "tracked.h"
+#include "typed_array.h"
 
 #include "tl/expected.hpp"
 
 namespace lyniat::ossp::serialize::bin {
 using namespace lyniat::memory::buffer;
 
-static constexpr Endianness endian = Big;
+// the header (magic number, EOD position and flags) is always written in this byte order
+static constexpr Endianness header_endian = Big;
+
+enum class IntEncoding : uint8_t {
+    Fixed = 0, // ST_INT followed by a full mrb_int
+    Compact    // ST_ADV_BYTE_1 ... ST_ADV_BYTE_8 followed by as few bytes as needed
+};
+
+// Compile-time options of a BasicOSSP engine. Every combination compiles to its own specialized code.
+template <IntEncoding Ints = IntEncoding::Fixed, Endianness E = Big, bool Checksum = false, uint16_t MaxDepth = 128>
+struct OSSPOptions {
+    static constexpr IntEncoding int_encoding = Ints;
+    static constexpr Endianness endian = E;
+    // appends a 32 bit FNV-1a checksum of the data in front of EOD
+    static constexpr bool checksum = Checksum;
+    static constexpr uint16_t max_depth = MaxDepth;
+
+    // written to the FLAGS header field
+    static constexpr uint64_t features = (Ints == IntEncoding::Compact ? FEATURE_COMPACT_INT : 0) |
+                                         (E == Big ? 0 : FEATURE_NATIVE_ENDIAN) |
+                                         (Checksum ? FEATURE_CHECKSUM : 0);
+};
+
+template <uint64_t Features>
+using FeatureOptions = OSSPOptions<(Features & FEATURE_COMPACT_INT) ? IntEncoding::Compact : IntEncoding::Fixed,
+                                   (Features & FEATURE_NATIVE_ENDIAN) ? Little : Big,
+                                   (Features & FEATURE_CHECKSUM) != 0>;
+
+// Calls visitor with the FeatureOptions matching features. Unsupported bits have to be rejected before.
+template <typename Visitor>
+auto dispatch_OSSP_features(uint64_t features, Visitor&& visitor) {
+    switch (features & SUPPORTED_FEATURES) {
+        case FEATURE_COMPACT_INT:
+            return visitor(FeatureOptions<FEATURE_COMPACT_INT>());
+        case FEATURE_NATIVE_ENDIAN:
+            return visitor(FeatureOptions<FEATURE_NATIVE_ENDIAN>());
+        case FEATURE_CHECKSUM:
+            return visitor(FeatureOptions<FEATURE_CHECKSUM>());
+        case FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN:
+            return visitor(FeatureOptions<FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN>());
+        case FEATURE_COMPACT_INT | FEATURE_CHECKSUM:
+            return visitor(FeatureOptions<FEATURE_COMPACT_INT | FEATURE_CHECKSUM>());
+        case FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM:
+            return visitor(FeatureOptions<FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM>());
+        case FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM:
+            return visitor(FeatureOptions<FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM>());
+        default:
+            return visitor(FeatureOptions<0>());
+    }
+}
+
+#ifdef ADV_SER
+using DefaultOptions = OSSPOptions<IntEncoding::Compact>;
+#else
+using DefaultOptions = OSSPOptions<>;
+#endif
+
+using CompactOptions = OSSPOptions<IntEncoding::Compact>;
+
+using CheckedOptions = OSSPOptions<IntEncoding::Compact, Big, true>;
 
 enum class OSSPErrorType : uint8_t {
     InvalidType = 0,
@@ -18,7 +88,17 @@ enum class OSSPErrorType : uint8_t {
     MissingMagicNumber,
     MissingEOD,
     MissingEOF,
-    WrongBufferSize
+    WrongBufferSize,
+    MaxDepthExceeded,
+    UnexpectedData,
+    ChecksumMismatch,
+    UnsupportedFeatures,
+    InvalidStructure,
+    SchemaMismatch,
+    InvalidJSON,
+    InvalidUTF8,
+    InvalidMessagePack,
+    InvalidPatch
 };
 
 struct OSSPErrorInfo {
@@ -45,6 +125,89 @@ const OSSPErrorInfo OSSPEOFError =
 const OSSPErrorInfo OSSPWrongBufferSizeError =
 {OSSPErrorType::WrongBufferSize, "Wrong buffer size.", 0};
 
+const OSSPErrorInfo OSSPMaxDepthError =
+{OSSPErrorType::MaxDepthExceeded, "Maximum nesting depth exceeded.", 0};
+
+const OSSPErrorInfo OSSPUnexpectedDataError =
+{OSSPErrorType::UnexpectedData, "Unexpected data before EOD.", 0};
+
+const OSSPErrorInfo OSSPChecksumError =
+{OSSPErrorType::ChecksumMismatch, "Checksum mismatch.", 0};
+
+const OSSPErrorInfo OSSPUnsupportedFeaturesError =
+{OSSPErrorType::UnsupportedFeatures, "Unsupported features.", 0};
+
+const OSSPErrorInfo OSSPInvalidStructureError =
+{OSSPErrorType::InvalidStructure, "Incomplete or invalid structure written.", 0};
+
+const OSSPErrorInfo OSSPSchemaMismatchError =
+{OSSPErrorType::SchemaMismatch, "Data was written with another schema.", 0};
+
+const OSSPErrorInfo OSSPInvalidJSONError =
+{OSSPErrorType::InvalidJSON, "Invalid JSON.", 0};
+
+const OSSPErrorInfo OSSPInvalidUTF8Error =
+{OSSPErrorType::InvalidUTF8, "Invalid UTF-8 in a string.", 0};
+
+const OSSPErrorInfo OSSPInvalidMessagePackError =
+{OSSPErrorType::InvalidMessagePack, "Invalid MessagePack.", 0};
+
+const OSSPErrorInfo OSSPInvalidPatchError =
+{OSSPErrorType::InvalidPatch, "Patch does not fit the target.", 0};
+
+inline tl::unexpected<OSSPErrorInfo> make_OSSP_error(const OSSPErrorInfo& info, size_t position) {
+    auto error = info;
+    error.position = position;
+    return tl::unexpected(error);
+}
+
+enum class KeyConversion : uint8_t {
+    Keep = 0,
+    Symbolize, // String keys become Symbols
+    Stringify  // Symbol keys become Strings
+};
+
+// Runtime options for materializing decoded data.
+struct DecodeOptions {
+    KeyConversion keys = KeyConversion::Keep;
+    // if set, Strings are frozen and shared through this table
+    StringTable* strings = nullptr;
+    // Decoding from a String source makes longer Strings share its buffer instead of copying.
+    // mRuby reference counts the shared buffer and copies a String once it gets modified.
+    bool zero_copy = false;
+    // set by Deserialize(mrb_value source, ...)
+    mrb_value source = mrb_nil_value();
+    // if set, Hashes with the keys of a registered record become instances of its class
+    const RecordTable* records = nullptr;
+};
+
+// Runtime options for encoding mRuby objects.
+struct EncodeOptions {
+    // if set, instances of registered record classes are written as Hashes
+    const RecordTable* records = nullptr;
+    // if set, Hashes with the keys of a registered layout are written as tables
+    const TableLayouts* tables = nullptr;
+    // if set, frozen Hashes and Arrays are encoded once and then copied from here
+    EncodeCache* cache = nullptr;
+};
+
+struct OSSPHeader {
+    uint32_t eod_position;
+    uint64_t flags;
+    size_t data_position;
+    bool has_meta_data;
+    size_t meta_data_position;
+    size_t meta_data_size;
+};
+
+// a table with its offsets read, see TableLayouts
+struct OSSPTable {
+    size_t position; // of its ST_TABLE
+    uint32_t size;
+    uint32_t layout;
+    st_counter_t fields;
+};
+
 inline std::string generate_OSSP_error_message(const OSSPErrorInfo& info) {
     std::stringstream ss;
     ss <<"Error 0x" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (uint64_t)info.type
@@ -52,22 +215,263 @@ inline std::string generate_OSSP_error_message(const OSSPErrorInfo& info) {
     return ss.str();
 }
 
-class OSSP {
+template <typename Options>
+class BasicWriter;
+
+template <typename Options>
+class BasicCursor;
+
+class SchemaMessage;
+
+class JSON;
+
+class MessagePack;
+
+template <typename Options>
+class BasicOSSP {
 public:
-    OSSP() = delete;
+    BasicOSSP() = delete;
+
+    ~BasicOSSP() = delete;
+
+    static constexpr Endianness endian = Options::endian;
+
+    static constexpr uint16_t max_depth = Options::max_depth;
+
+    static void Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const std::string& meta_data = "",
+                          const EncodeOptions& options = {});
+
+    // Writes a patch (see patch.h) with what changed in the TrackedHash or TrackedArray tracked since the last call
+    // and forgets those changes. Only marked slots are visited. Values that are not tracked are written as a whole.
+    static void EncodeChanges(ByteBuffer* bb, mrb_state* mrb, mrb_value tracked, const std::string& meta_data = "",
+                              const EncodeOptions& options = {});
+
+    // Writes a patch (see patch.h) that turns the value encoded in baseline into current.
+    // The baseline bytes are walked against current, so unchanged values produce no output and are not encoded.
+    // Changed numbers become XorInt and XorFloat operations. The patch uses the features of baseline.
+    static tl::expected<void, OSSPErrorInfo> EncodeDelta(ByteBuffer* bb, ReadBuffer* baseline, mrb_state* mrb,
+                                                         mrb_value current, const std::string& meta_data = "",
+                                                         const EncodeOptions& options = {});
 
-    ~OSSP() = delete;
+    static tl::expected<mrb_value, OSSPErrorInfo> Deserialize(ReadBuffer* bb, mrb_state* mrb,
+                                                              const DecodeOptions& options = {});
 
-    static void Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const std::string& meta_data = "");
+    // Decodes the bytes of the String source. This is the overload that allows DecodeOptions::zero_copy.
+    static tl::expected<mrb_value, OSSPErrorInfo> Deserialize(mrb_value source, mrb_state* mrb,
+                                                              const DecodeOptions& options = {});
 
-    static tl::expected<mrb_value, OSSPErrorInfo> Deserialize(ReadBuffer* bb, mrb_state* mrb);
+    // Applies a patch (see patch.h) to target in place and returns the new root, which only differs from target
+    // if the patch replaces it. Only the values on the paths of the operations are visited or created.
+    // The patch is validated before anything is changed, but an operation that does not fit target stops
+    // with the earlier operations applied. Frozen containers are not changed.
+    static tl::expected<mrb_value, OSSPErrorInfo> ApplyPatch(ReadBuffer* patch, mrb_state* mrb, mrb_value target,
+                                                             const DecodeOptions& options = {});
+
+    // Follows path (an Array of hash keys and array indices) through the encoded data and only
+    // materializes the value at its end. Everything else is skipped. Returns nil if the path does not exist.
+    static tl::expected<mrb_value, OSSPErrorInfo> Extract(ReadBuffer* rb, mrb_state* mrb, mrb_value path,
+                                                          const DecodeOptions& options = {});
+
+    // Materializes a Hash holding only those top level entries whose key is in keys (an Array).
+    static tl::expected<mrb_value, OSSPErrorInfo> Project(ReadBuffer* rb, mrb_state* mrb, mrb_value keys,
+                                                          const DecodeOptions& options = {});
+
+    // Compares the values encoded in a and b and returns an Array with the path (as for Extract) of every difference:
+    // values that differ, entries that only one side has and the elements of the longer Array.
+    // Both are walked in lockstep, equal subtrees are compared with memcmp and skipped. Meta data is ignored.
+    // Both have to be written with the same features.
+    static tl::expected<mrb_value, OSSPErrorInfo> Diff(ReadBuffer* a, ReadBuffer* b, mrb_state* mrb,
+                                                       const DecodeOptions& options = {});
+
+    // Checks the structure of untrusted data without creating any mRuby objects:
+    // header, type tags, lengths and counts against the remaining bytes, nesting depth and trailer.
+    static tl::expected<void, OSSPErrorInfo> Validate(ReadBuffer* rb);
 
 private:
-    static void SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data);
+    template <typename>
+    friend class BasicOSSP;
+
+    template <typename>
+    friend class BasicWriter;
+
+    template <typename>
+    friend class BasicCursor;
+
+    friend class SchemaMessage;
+
+    friend class JSON;
+
+    friend class MessagePack;
+
+    // writes header, checksum and trailer around the value written by write_data
+    template <typename F>
+    static void SerializeMessage(ByteBuffer* bb, const std::string& meta_data, F&& write_data);
+
+    // returns whether data and everything in it is frozen or immutable, so the written bytes can be cached
+    static bool SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options);
+
+    // writes the operations for the changes below tracked and returns their number
+    static size_t SerializeChanges(ByteBuffer* bb, mrb_state* mrb, mrb_value tracked, std::vector<mrb_value>* path,
+                                   const EncodeOptions& options);
+
+    static void SerializeOperation(ByteBuffer* bb, mrb_state* mrb, PatchOp op, const std::vector<mrb_value>& path,
+                                   const mrb_value* value, const EncodeOptions& options);
+
+    // writes a patch with count operations, or a single Set of value if an Array can not hold them
+    static void SerializePatch(ByteBuffer* bb, mrb_state* mrb, const ByteBuffer& operations, size_t count,
+                               mrb_value value, const std::string& meta_data, const EncodeOptions& options);
 
-    static tl::expected<mrb_value, OSSPErrorInfo> DeserializeRecursive(ReadBuffer* rb, mrb_state* mrb);
+    // compares the value at sr with current, writes operations for the differences and returns their number
+    static tl::expected<size_t, OSSPErrorInfo> SerializeDelta(ByteBuffer* bb, SpanReader* sr, mrb_state* mrb,
+                                                              mrb_value current, std::vector<mrb_value>* path,
+                                                              const EncodeOptions& options, uint16_t depth);
 
-    static tl::expected<mrb_value, OSSPErrorInfo> SetHashKey(ReadBuffer* rb, mrb_state* state, mrb_value hash);
+    static tl::expected<size_t, OSSPErrorInfo> SerializeHashDelta(ByteBuffer* bb, SpanReader* sr, mrb_state* mrb,
+                                                                  mrb_value current, std::vector<mrb_value>* path,
+                                                                  const EncodeOptions& options, uint16_t depth);
+
+    static tl::expected<size_t, OSSPErrorInfo> SerializeArrayDelta(ByteBuffer* bb, SpanReader* sr, mrb_state* mrb,
+                                                                   mrb_value current, std::vector<mrb_value>* path,
+                                                                   const EncodeOptions& options, uint16_t depth);
+
+    // applies the operation at sr to target and returns the new root
+    static tl::expected<mrb_value, OSSPErrorInfo> ApplyOperation(SpanReader* sr, mrb_state* mrb, mrb_value target,
+                                                                 const DecodeOptions& options);
+
+    // the child of container at step, nil if it does not exist
+    static tl::expected<mrb_value, OSSPErrorInfo> PatchChild(mrb_state* mrb, mrb_value container, mrb_value step,
+                                                             size_t position);
+
+    // replaces the child of container at step, or the root if there is no container
+    static tl::expected<mrb_value, OSSPErrorInfo> PatchReplace(mrb_state* mrb, mrb_value target, mrb_value container,
+                                                               mrb_value step, mrb_value value, size_t position);
+
+    // adds the differences between the values at a and b to differences, leaves both behind their value
+    static tl::expected<void, OSSPErrorInfo> DiffRecursive(SpanReader* a, SpanReader* b, mrb_state* mrb,
+                                                           std::vector<mrb_value>* path, mrb_value differences,
+                                                           const DecodeOptions& options, uint16_t depth);
+
+    static tl::expected<void, OSSPErrorInfo> DiffHash(SpanReader* a, SpanReader* b, mrb_state* mrb,
+                                                      std::vector<mrb_value>* path, mrb_value differences,
+                                                      const DecodeOptions& options, uint16_t depth);
+
+    static void AddDifference(mrb_state* mrb, const std::vector<mrb_value>& path, mrb_value differences);
+
+    // whether the value at sr is encoded exactly like current, leaves sr behind it
+    static tl::expected<bool, OSSPErrorInfo> MatchValue(SpanReader* sr, mrb_state* mrb, mrb_value current,
+                                                        const EncodeOptions& options);
+
+    // SerializeRecursive without the lookup in EncodeOptions::cache
+    static bool SerializeValue(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options);
+
+    static bool SerializeCached(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options);
+
+    static void SerializeTypedArray(ByteBuffer* bb, const TypedArray* array);
+
+    static bool SerializeTable(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const TableLayouts::Layout& layout,
+                               const EncodeOptions& options);
+
+    static void SerializeRecord(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const RecordTable::Record& record,
+                                const EncodeOptions& options);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DeserializeSpan(SpanReader sr, mrb_state* mrb,
+                                                                  const DecodeOptions& options);
+
+    static tl::expected<OSSPHeader, OSSPErrorInfo> ReadHeader(SpanReader* sr, uint64_t supported = SUPPORTED_FEATURES);
+
+    // returns a reader limited to the encoded value, after verifying the checksum if the options have one
+    static tl::expected<SpanReader, OSSPErrorInfo> DataReader(const SpanReader& sr, const OSSPHeader& header);
+
+    static uint32_t Checksum(const uint8_t* data, size_t size);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DeserializeRecursive(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                                       uint16_t depth = 0);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> SetHashKey(SpanReader* sr, mrb_state* state, mrb_value hash, const DecodeOptions& options,
+                                                             uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeHashKey(SpanReader* sr, mrb_state* state, const DecodeOptions& options,
+                                                                uint16_t depth = 0);
+
+    static bool IsKeyType(uint8_t type);
+
+    // a failed entry is reported as a reading error at its position, unless the depth limit was hit
+    static tl::unexpected<OSSPErrorInfo> DecodeFailure(const OSSPErrorInfo& error, size_t position);
+
+    typedef tl::expected<mrb_value, OSSPErrorInfo> (*DecodeHandler)(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                                uint16_t depth);
+
+    // indexed by serialized_type, shared by DeserializeRecursive and SetHashKey
+    static const std::array<DecodeHandler, 256> decode_handlers;
+
+    static constexpr std::array<DecodeHandler, 256> CreateDecodeHandlers();
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeFalse(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                              uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeTrue(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                             uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeNil(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                            uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeInt(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                            uint16_t depth);
+
+    template <uint8_t N>
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeCompactInt(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                                   uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeFloat(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                              uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeString(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                               uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeSymbol(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                               uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeHash(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                             uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeTable(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                              uint16_t depth);
+
+    // decodes hash_size keys and values into a Hash or, with options.records, a record
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeHashEntries(SpanReader* sr, mrb_state* mrb, st_counter_t hash_size,
+                                                                    const DecodeOptions& options, uint16_t depth);
+
+    // decodes the entries of a Hash with hash_size keys and tries options.records before building the Hash
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeRecord(SpanReader* sr, mrb_state* mrb, st_counter_t hash_size,
+                                                               const DecodeOptions& options, uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeArray(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                              uint16_t depth);
+
+    template <TypedArrayType Type>
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeTypedArray(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                                   uint16_t depth);
+
+    static tl::expected<mrb_value, OSSPErrorInfo> DecodeInvalid(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                                uint16_t depth);
+
+    static tl::expected<std::string_view, OSSPErrorInfo> ReadCounted(SpanReader* sr);
+
+    static bool ReadCompactInt(SpanReader* sr, uint8_t n_bytes, int64_t* value);
+
+    // called after ST_TABLE, leaves sr in front of the first entry
+    static tl::expected<OSSPTable, OSSPErrorInfo> ReadTable(SpanReader* sr);
+
+    // moves sr in front of the key of entry index in O(1)
+    static tl::expected<void, OSSPErrorInfo> SeekTableEntry(SpanReader* sr, const OSSPTable& table, st_counter_t index);
+
+    static tl::expected<bool, OSSPErrorInfo> SeekChild(SpanReader* sr, mrb_state* mrb, mrb_value step);
+
+    static tl::expected<bool, OSSPErrorInfo> MatchKey(SpanReader* sr, mrb_state* mrb, mrb_value key);
+
+    static tl::expected<void, OSSPErrorInfo> SkipKey(SpanReader* sr, uint16_t depth = 0);
+
+    static tl::expected<void, OSSPErrorInfo> SkipValue(SpanReader* sr, uint16_t depth = 0);
 
     static tl::expected<mrb_value, OSSPErrorInfo> AddHashKey(ByteBuffer* bb, mrb_state* state, mrb_value key);
 
@@ -78,4 +482,29 @@ private:
     static serialized_type GetMinBytes(int64_t value);
 };
 
+using OSSP = BasicOSSP<DefaultOptions>;
+
+// Per connection choice of the encoding. Decoding always follows the FLAGS of the received data,
+// so peers with different profiles can still read each other.
+class EncoderProfile {
+public:
+    explicit EncoderProfile(uint64_t features = DefaultOptions::features);
+
+    // Picks the fastest encoding out of wanted that both peers support.
+    // Peers that predate the FLAGS field have to announce 0.
+    static EncoderProfile Negotiate(uint64_t local_features, uint64_t remote_features,
+                                    uint64_t wanted = FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN);
+
+    uint64_t Features() const;
+
+    void Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const std::string& meta_data = "",
+                   const EncodeOptions& options = {}) const;
+
+    tl::expected<mrb_value, OSSPErrorInfo> Deserialize(ReadBuffer* rb, mrb_state* mrb,
+                                                       const DecodeOptions& options = {}) const;
+
+private:
+    uint64_t m_features;
+};
+
 }
\ No newline at end of file
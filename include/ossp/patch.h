@@ -0,0 +1,53 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace lyniat::ossp::serialize::bin {
+
+// Patches are ordinary OSSP messages whose value is an Array of operations, applied in order:
+//
+//     [PatchOp::Set, path, value]      path gets value, a missing Hash entry is added
+//     [PatchOp::Delete, path]          the Hash entry at path is removed
+//     [PatchOp::Resize, path, size]    the Array at path is cut or filled up with nil to size
+//     [PatchOp::XorInt, path, bits]    the Integer at path is XORed with bits
+//     [PatchOp::XorFloat, path, bits]  the bit pattern of the Float at path is XORed with bits (an Integer)
+//
+// The XOR operations carry only the bits that differ from the old number. For the small steps numbers
+// usually take, these are mostly zeros, which compact integers and compression get rid of.
+// path is an Array of hash keys and array indices from the root, as for BasicOSSP::Extract.
+// The empty path stands for the root itself. Being plain OSSP, patches can be validated,
+// inspected with the cursor or converted to JSON like any other message.
+enum class PatchOp : uint8_t {
+    Set = 0,
+    Delete,
+    Resize,
+    XorInt,
+    XorFloat
+};
+
+}
@@ -0,0 +1,111 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <bytebuffer/ByteBuffer.h>
+#include <cstdint>
+#include <cstring>
+
+namespace lyniat::ossp::serialize::bin {
+using namespace lyniat::memory::buffer;
+
+// Non-owning view over the bytes of a ReadBuffer with its own reading position.
+// Unlike ReadBuffer it can seek and skip, so subtrees can be jumped over without copying them.
+class SpanReader {
+public:
+    SpanReader(const uint8_t* data, size_t size, size_t pos = 0) : m_data(data), m_size(size), m_pos(pos) {}
+
+    explicit SpanReader(ReadBuffer* rb) :
+        SpanReader((const uint8_t*)rb->DataAt(0), rb->Size(), rb->CurrentReadingPos()) {}
+
+    template <typename T>
+    bool ReadWithEndian(T* value, Endianness endianness) {
+        if (Remaining() < sizeof(T)) {
+            return false;
+        }
+        ReadUnchecked(value, endianness);
+        return true;
+    }
+
+    // caller guarantees Remaining() >= sizeof(T)
+    template <typename T>
+    void ReadUnchecked(T* value, Endianness endianness) {
+        uint8_t bytes[sizeof(T)];
+        if ((endianness == Big) == HostIsLittleEndian()) {
+            for (size_t i = 0; i < sizeof(T); i++) {
+                bytes[i] = m_data[m_pos + sizeof(T) - 1 - i];
+            }
+        } else {
+            memcpy(bytes, m_data + m_pos, sizeof(T));
+        }
+        memcpy(value, bytes, sizeof(T));
+        m_pos += sizeof(T);
+    }
+
+    bool Skip(size_t n) {
+        if (Remaining() < n) {
+            return false;
+        }
+        m_pos += n;
+        return true;
+    }
+
+    const uint8_t* Current() const {
+        return m_data + m_pos;
+    }
+
+    const uint8_t* DataAt(size_t pos) const {
+        return m_data + pos;
+    }
+
+    size_t Remaining() const {
+        return m_size - m_pos;
+    }
+
+    size_t Size() const {
+        return m_size;
+    }
+
+    size_t CurrentReadingPos() const {
+        return m_pos;
+    }
+
+    void SetReadingPos(size_t pos) {
+        m_pos = pos;
+    }
+
+    static bool HostIsLittleEndian() {
+        const uint16_t probe = 1;
+        return *(const uint8_t*)&probe == 1;
+    }
+
+private:
+
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos;
+};
+
+}
@@ -0,0 +1,76 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "../mruby.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lyniat::ossp::serialize::bin {
+
+// Classes whose instances stand in for Hashes with a known set of Symbol keys.
+// Such an object keeps one instance variable per key (:hp is stored as @hp), which is a lot
+// lighter than a Hash and gives direct field access through attr_reader.
+// Decoding creates the objects without calling initialize, Serialize writes them back as Hashes.
+class RecordTable {
+public:
+    struct Record {
+        RClass* record_class;
+        std::vector<mrb_sym> keys;
+        std::vector<mrb_sym> ivars;
+    };
+
+    explicit RecordTable(mrb_state* mrb);
+
+    ~RecordTable();
+
+    RecordTable(const RecordTable&) = delete;
+
+    RecordTable& operator=(const RecordTable&) = delete;
+
+    // keys must be unique, a later registration of the same key set is never matched
+    void Register(mrb_state* mrb, RClass* record_class, const std::vector<mrb_sym>& keys);
+
+    // cheap check before a Hash of this size gets decoded into key/value pairs
+    bool MayMatch(size_t size) const;
+
+    // entries holds size key/value pairs. Returns an instance of the Record with exactly these keys or nil.
+    mrb_value Materialize(mrb_state* mrb, const mrb_value* entries, size_t size) const;
+
+    // returns the Record registered for the class of obj or nullptr
+    const Record* Find(mrb_value obj) const;
+
+private:
+    // returns the index of key in record.keys or its size
+    static size_t FindSlot(const Record& record, mrb_sym key, size_t hint);
+
+    mrb_state* m_mrb;
+    std::vector<Record> m_records;
+    // bit n is set if a Record has n keys, larger sizes always set the last bit
+    uint64_t m_sizes = 0;
+};
+
+}
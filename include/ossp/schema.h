@@ -0,0 +1,54 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <bytebuffer/ByteBuffer.h>
+#include <string>
+#include "ossp.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+// Framing of messages written by code that ossp_schema generated from a schema.
+// They keep the usual header and trailer, but FLAGS has FEATURE_SCHEMA set and the body is
+// a 32 bit schema id followed by the fields in schema order: no type tags, no keys, little endian.
+// Only the generated code of the same schema can read them, the generic decoders reject them.
+class SchemaMessage {
+public:
+    static constexpr uint64_t features = FEATURE_SCHEMA | FEATURE_NATIVE_ENDIAN;
+
+    static constexpr Endianness endian = Little;
+
+    SchemaMessage() = delete;
+
+    // writes header and schema id into the empty buffer bb
+    static void Begin(ByteBuffer* bb, uint32_t schema_id);
+
+    static void Finish(ByteBuffer* bb, const std::string& meta_data = "");
+
+    // checks the framing and the schema id and returns a reader limited to the fields
+    static tl::expected<SpanReader, OSSPErrorInfo> Open(ReadBuffer* rb, uint32_t schema_id);
+};
+
+}
@@ -42,7 +42,18 @@ static constexpr uint8_t FLAG_SERVER = 0b00000001;
 static constexpr uint8_t FLAG_CLIENTS = 0b00000010;
 static constexpr uint8_t FLAG_SELF = 0b00000100;
 
+// feature bits of the FLAGS header field, describing how the data behind the header is encoded
+static constexpr uint64_t FEATURE_COMPACT_INT = 1ULL << 0;   // integers as ST_ADV_BYTE_1 ... ST_ADV_BYTE_8
+static constexpr uint64_t FEATURE_KEY_TABLE = 1ULL << 1;     // reserved
+static constexpr uint64_t FEATURE_COMPRESSION = 1ULL << 2;   // reserved
+static constexpr uint64_t FEATURE_NATIVE_ENDIAN = 1ULL << 3; // little endian data, native on all supported targets
+static constexpr uint64_t FEATURE_CHECKSUM = 1ULL << 4;      // 32 bit checksum in front of EOD
+static constexpr uint64_t FEATURE_SCHEMA = 1ULL << 5;        // untagged body of a generated schema message, see schema.h
+
+static constexpr uint64_t SUPPORTED_FEATURES = FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM;
+
 typedef uint16_t st_counter_t;
+typedef uint32_t st_block_counter_t; // element count of typed arrays
 
 enum serialized_type : uint8_t {
     ST_FALSE = 0,
@@ -55,6 +66,9 @@ enum serialized_type : uint8_t {
     ST_STRING,
     ST_UNDEF,
     ST_NIL,
+    ST_FLOAT64_ARRAY, // st_block_counter_t count, then count doubles as one block
+    ST_INT64_ARRAY,   // st_block_counter_t count, then count int64_t as one block
+    ST_TABLE,         // Hash with a registered key set, see TableLayouts
     ST_EOD = 69, // 69 = ASCII E / could also be EOF
     ST_ADV_BYTE_1 = 127,
     ST_ADV_BYTE_2,
@@ -0,0 +1,96 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <bytebuffer/ByteBuffer.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ossp.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+// what SnapshotHistory::Encode wrote, to be sent along with the message
+struct SnapshotInfo {
+    uint32_t seq;
+    bool delta;        // the message is a patch against the snapshot baseline, otherwise the whole value
+    uint32_t baseline;
+};
+
+// The snapshots recently sent over one connection, so every new one can be sent as a delta against
+// the newest snapshot the peer acknowledged. Sequence numbers count up from 0 and may wrap around.
+// The full encoding of each snapshot is kept in a ring of capacity entries. An unchanged snapshot
+// shares the bytes of the one before. Snapshots older than the acknowledged one are released, since
+// they never become a baseline again.
+class SnapshotHistory {
+public:
+    explicit SnapshotHistory(uint64_t features = DefaultOptions::features, size_t capacity = 32);
+
+    // Encodes data as the next snapshot. This is a patch against the newest acknowledged snapshot if there is one
+    // and it is smaller than the whole value, otherwise the whole value.
+    tl::expected<SnapshotInfo, OSSPErrorInfo> Encode(ByteBuffer* bb, mrb_state* mrb, mrb_value data,
+                                                     const std::string& meta_data = "",
+                                                     const EncodeOptions& options = {});
+
+    // Marks seq as received by the peer. Returns false if it is not known anymore or older than the current baseline.
+    bool Ack(uint32_t seq);
+
+    // the full encoding of seq, nullptr if it is not kept
+    ByteBuffer* Find(uint32_t seq) const;
+
+    bool HasBaseline() const;
+
+    // seq of the newest acknowledged snapshot, only valid if HasBaseline()
+    uint32_t Baseline() const;
+
+    // the seq the next call of Encode uses
+    uint32_t NextSeq() const;
+
+    // snapshots kept
+    size_t Size() const;
+
+    uint64_t Features() const;
+
+    // forgets every snapshot, for example after the peer reconnected
+    void Reset();
+
+private:
+    struct Entry {
+        uint32_t seq;
+        std::shared_ptr<ByteBuffer> bytes;
+    };
+
+    Entry* Slot(uint32_t seq);
+
+    uint64_t m_features;
+    std::vector<Entry> m_entries;
+    uint32_t m_next_seq = 0;
+    bool m_has_baseline = false;
+    uint32_t m_baseline = 0;
+};
+
+}
@@ -0,0 +1,59 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "../mruby.h"
+#include <cstddef>
+
+namespace lyniat::ossp::serialize::bin {
+
+// Bounded table of frozen strings that decoding hands out instead of allocating a new String
+// for every occurrence. Slots are direct mapped by a hash of the content, so a colliding string
+// replaces the old one. The table keeps its strings alive and has to be destroyed before mrb_close.
+class StringTable {
+public:
+    explicit StringTable(mrb_state* mrb, size_t capacity = 4096, size_t max_length = 64);
+
+    ~StringTable();
+
+    StringTable(const StringTable&) = delete;
+
+    StringTable& operator=(const StringTable&) = delete;
+
+    // returns a frozen String, shared with all earlier calls for the same content if it is still cached
+    mrb_value Get(mrb_state* mrb, const char* str, size_t len);
+
+    void Clear();
+
+private:
+    static size_t Hash(const char* str, size_t len);
+
+    mrb_state* m_mrb;
+    mrb_value m_slots;
+    size_t m_capacity;
+    size_t m_max_length;
+};
+
+}
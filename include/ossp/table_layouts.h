@@ -0,0 +1,71 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "../mruby.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace lyniat::ossp::serialize::bin {
+
+// Key sets of Hashes that are written as tables instead of plain Hashes.
+// A table starts with a vtable holding the offset of every entry, so readers that know the layout
+// jump straight to a field (see BasicCursor::SeekField) instead of skipping all values in front of it.
+// Entries follow in the order of the layout keys, which makes them readable as a normal Hash as well.
+//
+//     ST_TABLE
+//     st_block_counter_t size     bytes from ST_TABLE to the end of the last entry
+//     uint32_t layout             TableLayouts::LayoutId of the key names
+//     st_counter_t fields
+//     st_block_counter_t offsets[fields]  from ST_TABLE to the key of each entry
+//     fields keys and values
+class TableLayouts {
+public:
+    struct Layout {
+        uint32_t id;
+        std::vector<mrb_sym> keys;
+    };
+
+    // size of everything in front of the offsets
+    static constexpr size_t header_size = 1 + 4 + 4 + 2;
+
+    // keys must be unique Symbols. Returns the layout id.
+    uint32_t Register(mrb_state* mrb, const std::vector<mrb_sym>& keys);
+
+    // returns the Layout with exactly the keys of hash or nullptr
+    const Layout* Find(mrb_state* mrb, mrb_value hash) const;
+
+    // FNV-1a over the key names, so readers without an mrb_state can check which layout they got
+    static uint32_t LayoutId(const std::vector<std::string_view>& names);
+
+private:
+    std::vector<Layout> m_layouts;
+    // bit n is set if a Layout has n keys, larger sizes always set the last bit
+    uint64_t m_sizes = 0;
+};
+
+}
@@ -0,0 +1,89 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "../mruby.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lyniat::ossp::serialize::bin {
+
+// Native state of OSSP::TrackedHash and OSSP::TrackedArray.
+// Every write marks its slot in a bitset: array indices, or for Hashes a slot number the key got when it
+// was first stored. A container with changes also marks its slot in the tracked container holding it,
+// up to the root, so BasicOSSP::EncodeChanges only has to follow marked slots.
+// The values, the slot keys and the parent live in instance variables where the GC sees them.
+struct TrackedContainer {
+    bool hash;
+    std::vector<uint64_t> dirty;    // slots written since the last clear
+    std::vector<uint64_t> children; // slots holding a tracked container with changes of its own
+    size_t synced_size;             // size of an Array at the last clear
+    size_t parent_slot;             // slot of this container in its parent
+    std::vector<size_t> free_slots; // slots of keys deleted before the last clear, ready for new keys
+};
+
+// Defines OSSP::TrackedHash and OSSP::TrackedArray.
+// TrackedHash: new(hash = {}), [], []=, delete, key?, size, keys, each, to_h and changed?.
+// TrackedArray: new(array or size = 0), [], []=, push, <<, pop, size, each, to_a and changed?.
+// Hashes and Arrays passed to new or stored later are converted into tracked containers, so changes anywhere
+// below are found. A deleted key keeps its slot until the Delete was encoded, then the slot is reused.
+// Both are encoded like a Hash and an Array.
+void define_OSSP_tracked(mrb_state* mrb);
+
+// returns nullptr unless value is a TrackedHash or TrackedArray
+TrackedContainer* get_OSSP_tracked(mrb_value value);
+
+// the Hash or Array holding the values of a tracked container
+mrb_value get_OSSP_tracked_data(mrb_state* mrb, mrb_value tracked);
+
+// the key of slot in a TrackedHash
+mrb_value get_OSSP_tracked_key(mrb_state* mrb, mrb_value tracked, size_t slot);
+
+// forgets the changes of tracked and every tracked container below it
+void clear_OSSP_tracked(mrb_state* mrb, mrb_value tracked);
+
+inline bool test_OSSP_slot(const std::vector<uint64_t>& slots, size_t slot) {
+    return slot / 64 < slots.size() && (slots[slot / 64] & ((uint64_t)1 << (slot % 64))) != 0;
+}
+
+// calls f(slot) for every set bit in slots
+template <typename F>
+void for_each_OSSP_slot(const std::vector<uint64_t>& slots, F&& f) {
+    for (size_t word = 0; word < slots.size(); word++) {
+        auto bits = slots[word];
+        while (bits != 0) {
+            size_t bit = 0;
+            while ((bits & ((uint64_t)1 << bit)) == 0) {
+                bit++;
+            }
+            bits &= bits - 1;
+            f(word * 64 + bit);
+        }
+    }
+}
+
+}
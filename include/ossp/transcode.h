@@ -0,0 +1,81 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <bytebuffer/ByteBuffer.h>
+#include <string>
+#include "json.h"
+#include "msgpack.h"
+#include "ossp.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+// Converts between OSSP and JSON buffer to buffer, without an mrb_state and without building any values.
+// The output matches JSON::Serialize of the decoded value and OSSP::Serialize of the parsed one.
+// Strings are checked to be valid UTF-8 in both directions.
+
+// Writes the value of one OSSP message as JSON to out. Meta data is dropped.
+tl::expected<void, OSSPErrorInfo> transcode_OSSP_to_JSON(const uint8_t* data, size_t size, ByteBuffer* out);
+
+tl::expected<void, OSSPErrorInfo> transcode_OSSP_to_JSON(ReadBuffer* rb, ByteBuffer* out);
+
+// Writes one JSON value as an OSSP message with the given features to out. Object keys become
+// Strings, or Symbols with KeyConversion::Symbolize.
+tl::expected<void, OSSPErrorInfo> transcode_JSON_to_OSSP(const uint8_t* data, size_t size, ByteBuffer* out,
+                                                        KeyConversion keys = KeyConversion::Keep,
+                                                        uint64_t features = DefaultOptions::features,
+                                                        const std::string& meta_data = "");
+
+tl::expected<void, OSSPErrorInfo> transcode_JSON_to_OSSP(ReadBuffer* rb, ByteBuffer* out,
+                                                        KeyConversion keys = KeyConversion::Keep,
+                                                        uint64_t features = DefaultOptions::features,
+                                                        const std::string& meta_data = "");
+
+// Converts between OSSP and MessagePack the same way. The output matches MessagePack::Serialize of
+// the decoded value and OSSP::Serialize of the parsed one, Symbols travel as MSGPACK_SYMBOL_EXT.
+
+// Writes the value of one OSSP message as MessagePack to out. Meta data is dropped.
+tl::expected<void, OSSPErrorInfo> transcode_OSSP_to_MessagePack(const uint8_t* data, size_t size, ByteBuffer* out);
+
+tl::expected<void, OSSPErrorInfo> transcode_OSSP_to_MessagePack(ReadBuffer* rb, ByteBuffer* out);
+
+// Writes one MessagePack value as an OSSP message with the given features to out. KeyConversion applies
+// to String and Symbol keys. OSSP keys are Strings, Symbols, Integers or Floats, other keys fail with
+// InvalidType, containers of more than 65535 entries with InvalidStructure.
+tl::expected<void, OSSPErrorInfo> transcode_MessagePack_to_OSSP(const uint8_t* data, size_t size, ByteBuffer* out,
+                                                               KeyConversion keys = KeyConversion::Keep,
+                                                               uint64_t features = DefaultOptions::features,
+                                                               const std::string& meta_data = "");
+
+tl::expected<void, OSSPErrorInfo> transcode_MessagePack_to_OSSP(ReadBuffer* rb, ByteBuffer* out,
+                                                               KeyConversion keys = KeyConversion::Keep,
+                                                               uint64_t features = DefaultOptions::features,
+                                                               const std::string& meta_data = "");
+
+// Returns the size of the OSSP message at the start of data including its trailer, or 0 if it is incomplete.
+// Splits captures of several messages written back to back.
+size_t get_OSSP_message_size(const uint8_t* data, size_t size);
+
+}
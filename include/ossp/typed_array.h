@@ -0,0 +1,57 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include "../mruby.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace lyniat::ossp::serialize::bin {
+
+enum class TypedArrayType : uint8_t {
+    Float64 = 0,
+    Int64
+};
+
+// Native storage of OSSP::Float64Array and OSSP::Int64Array.
+// The elements live in one contiguous buffer that is owned by the Ruby object and freed with it.
+struct TypedArray {
+    TypedArrayType type;
+    size_t size;
+    void* data; // double or int64_t elements
+};
+
+// Defines OSSP::Float64Array and OSSP::Int64Array with new(size or Array), [], []=, each, size and to_a.
+// Decoding only creates typed arrays after this was called, otherwise they become Arrays.
+void define_OSSP_typed_arrays(mrb_state* mrb);
+
+// returns nullptr unless value is a Float64Array or Int64Array
+TypedArray* get_OSSP_typed_array(mrb_value value);
+
+// Returns a typed array with size uninitialized elements that the caller fills through array,
+// or nil if define_OSSP_typed_arrays was not called for mrb.
+mrb_value new_OSSP_typed_array(mrb_state* mrb, TypedArrayType type, size_t size, TypedArray** array);
+
+}
@@ -0,0 +1,225 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <bytebuffer/ByteBuffer.h>
+#include <array>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "ossp.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+// specialized by OSSP_FIELDS, see fields.h
+template <typename T>
+struct OSSPFields {
+    static constexpr bool defined = false;
+};
+
+template <typename T>
+struct IsStdOptional : std::false_type {};
+
+template <typename T>
+struct IsStdOptional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+struct IsStdVector : std::false_type {};
+
+template <typename T, typename A>
+struct IsStdVector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+struct IsStdMap : std::false_type {};
+
+template <typename K, typename V, typename C, typename A>
+struct IsStdMap<std::map<K, V, C, A>> : std::true_type {};
+
+template <typename K, typename V, typename H, typename E, typename A>
+struct IsStdMap<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+template <typename Options>
+class BasicWriter;
+
+template <typename Options, typename T>
+void write_OSSP_fields(BasicWriter<Options>& writer, const T& value);
+
+// Writes OSSP directly from C++ values, without an mrb_state.
+// The output is identical to BasicOSSP<Options>::Serialize of the equivalent mRuby value:
+//
+//     Writer writer(bb);
+//     writer.BeginHash(2).SymbolKey("id").Int(7).SymbolKey("name").String("raccoon");
+//     auto done = writer.Finish();
+//
+// Containers announce their size up front, so there is nothing to close. Each hash entry is a
+// key followed by its value. Calls in the wrong order make Finish fail with InvalidStructure.
+// Containers of unknown size are started without one and closed by End, which writes their size.
+template <typename Options>
+class BasicWriter {
+public:
+    static constexpr Endianness endian = Options::endian;
+
+    // starts writing the header into the empty buffer bb
+    explicit BasicWriter(ByteBuffer* bb);
+
+    BasicWriter& Nil();
+
+    BasicWriter& Bool(bool value);
+
+    BasicWriter& Int(int64_t value);
+
+    BasicWriter& Float(double value);
+
+    BasicWriter& String(std::string_view value);
+
+    BasicWriter& Symbol(std::string_view value);
+
+    BasicWriter& BeginHash(st_counter_t size);
+
+    BasicWriter& BeginArray(st_counter_t size);
+
+    BasicWriter& BeginHash();
+
+    BasicWriter& BeginArray();
+
+    // closes the innermost container started without a size
+    BasicWriter& End();
+
+    // decoded as OSSP::Float64Array / OSSP::Int64Array if the host defined them, otherwise as Array
+    BasicWriter& Float64Array(const double* values, size_t size);
+
+    BasicWriter& Int64Array(const int64_t* values, size_t size);
+
+    // String key
+    BasicWriter& Key(std::string_view key);
+
+    BasicWriter& SymbolKey(std::string_view key);
+
+    BasicWriter& Key(int64_t key);
+
+    // appends a key that is already encoded with type, length and name, as precomputed by OSSP_FIELDS
+    BasicWriter& EncodedKey(const uint8_t* bytes, size_t size);
+
+    template <typename T>
+    BasicWriter& Write(const T& value);
+
+    // Appends checksum and trailer and sets the EOD position. Fails if the written value is incomplete.
+    tl::expected<void, OSSPErrorInfo> Finish(const std::string& meta_data = "");
+
+private:
+    struct Frame {
+        uint32_t remaining; // hashes count keys and values separately, containers without size count up
+        bool hash;
+        bool open;
+        size_t size_pos; // of the size an open container gets at its End
+    };
+
+    // bookkeeping before every key or value, returns false if it is not expected here
+    bool Expect(bool key);
+
+    void Push(bool hash, uint32_t remaining, bool open = false);
+
+    BasicWriter& BeginOpen(serialized_type type);
+
+    // pops all containers that got their last value
+    void Close();
+
+    void AppendCounted(serialized_type type, std::string_view value);
+
+    template <typename K>
+    void WriteKey(const K& key);
+
+    ByteBuffer* m_bb;
+    size_t m_start;
+    size_t m_data_pos;
+    std::array<Frame, Options::max_depth> m_frames;
+    uint16_t m_depth = 0;
+    bool m_root_written = false;
+    bool m_failed = false;
+};
+
+using Writer = BasicWriter<DefaultOptions>;
+
+template <typename Options>
+template <typename T>
+BasicWriter<Options>& BasicWriter<Options>::Write(const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        return Bool(value);
+    } else if constexpr (std::is_integral_v<T>) {
+        return Int((int64_t)value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return Float((double)value);
+    } else if constexpr (std::is_same_v<T, std::nullptr_t>) {
+        return Nil();
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        return String(value);
+    } else if constexpr (IsStdOptional<T>::value) {
+        return value.has_value() ? Write(*value) : Nil();
+    } else if constexpr (IsStdVector<T>::value) {
+        if (value.size() > UINT16_MAX) {
+            m_failed = true;
+            return *this;
+        }
+        BeginArray((st_counter_t)value.size());
+        for (const auto& element : value) {
+            Write(element);
+        }
+        return *this;
+    } else if constexpr (IsStdMap<T>::value) {
+        if (value.size() > UINT16_MAX) {
+            m_failed = true;
+            return *this;
+        }
+        BeginHash((st_counter_t)value.size());
+        for (const auto& [key, element] : value) {
+            WriteKey(key);
+            Write(element);
+        }
+        return *this;
+    } else if constexpr (OSSPFields<T>::defined) {
+        write_OSSP_fields(*this, value);
+        return *this;
+    } else {
+        static_assert(!sizeof(T), "type can not be written as OSSP");
+    }
+}
+
+template <typename Options>
+template <typename K>
+void BasicWriter<Options>::WriteKey(const K& key) {
+    if constexpr (std::is_integral_v<K> && !std::is_same_v<K, bool>) {
+        Key((int64_t)key);
+    } else if constexpr (std::is_convertible_v<const K&, std::string_view>) {
+        Key(std::string_view(key));
+    } else {
+        static_assert(!sizeof(K), "only strings and integers can be written as hash keys");
+    }
+}
+
+}
@@ -0,0 +1,319 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/cursor.h"
+
+#include <cstring>
+
+namespace lyniat::ossp::serialize::bin {
+
+template <typename Options>
+tl::expected<BasicCursor<Options>, OSSPErrorInfo> BasicCursor<Options>::Open(ReadBuffer* rb) {
+    SpanReader sr(rb);
+    return Open(sr.DataAt(0), sr.Size());
+}
+
+template <typename Options>
+tl::expected<BasicCursor<Options>, OSSPErrorInfo> BasicCursor<Options>::Open(const uint8_t* data, size_t size) {
+    SpanReader sr(data, size);
+    auto header = BasicOSSP<Options>::ReadHeader(&sr);
+    if (!header) {
+        return tl::unexpected(header.error());
+    }
+    if (header->flags != Options::features) {
+        return make_OSSP_error(OSSPUnsupportedFeaturesError, sizeof(LE_MAGIC_NUMBER) + sizeof(EOD_POSITION));
+    }
+    auto data_sr = BasicOSSP<Options>::DataReader(sr, header.value());
+    if (!data_sr) {
+        return tl::unexpected(data_sr.error());
+    }
+    std::string_view meta_data;
+    if (header->has_meta_data) {
+        meta_data = std::string_view((const char*)sr.DataAt(header->meta_data_position), header->meta_data_size);
+    }
+    return BasicCursor<Options>(data_sr.value(), meta_data);
+}
+
+template <typename Options>
+BasicCursor<Options>::BasicCursor(SpanReader sr, std::string_view meta_data) :
+    m_sr(sr), m_meta_data(meta_data), m_frames(), m_depth(1) {
+    // the top level is a container of exactly one value
+    m_frames[0] = {1, false, {}};
+}
+
+template <typename Options>
+tl::expected<CursorValue, OSSPErrorInfo> BasicCursor<Options>::Next() {
+    CursorValue value = {};
+    auto frame = Current();
+    if (frame == nullptr) {
+        if (m_depth > 1) {
+            m_depth--;
+        }
+        value.event = CursorEvent::End;
+        return value;
+    }
+    value.key = frame->hash && frame->remaining % 2 == 0;
+
+    uint8_t bin_type;
+    if (!m_sr.ReadWithEndian(&bin_type, endian)) {
+        return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+    }
+    if (value.key && !BasicOSSP<Options>::IsKeyType(bin_type)) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, m_sr.CurrentReadingPos());
+    }
+    frame->remaining--;
+
+    switch (bin_type) {
+        case ST_NIL:
+        case ST_EOD:
+            value.event = CursorEvent::Nil;
+            return value;
+        case ST_FALSE:
+        case ST_TRUE:
+            value.event = CursorEvent::Bool;
+            value.boolean = bin_type == ST_TRUE;
+            return value;
+        case ST_INT: {
+            mrb_int number;
+            if (!m_sr.ReadWithEndian(&number, endian)) {
+                return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+            }
+            value.event = CursorEvent::Int;
+            value.integer = number;
+            return value;
+        }
+        case ST_FLOAT: {
+            mrb_float number;
+            if (!m_sr.ReadWithEndian(&number, endian)) {
+                return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+            }
+            value.event = CursorEvent::Float;
+            value.number = number;
+            return value;
+        }
+        case ST_STRING:
+        case ST_SYMBOL: {
+            auto data = BasicOSSP<Options>::ReadCounted(&m_sr);
+            if (!data) {
+                return tl::unexpected(data.error());
+            }
+            value.event = bin_type == ST_STRING ? CursorEvent::String : CursorEvent::Symbol;
+            value.string = data.value();
+            return value;
+        }
+        case ST_HASH:
+        case ST_ARRAY: {
+            st_counter_t size;
+            if (!m_sr.ReadWithEndian(&size, endian)) {
+                return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+            }
+            bool hash = bin_type == ST_HASH;
+            auto pushed = Push(hash, hash ? (uint32_t)size * 2 : size);
+            if (!pushed) {
+                return tl::unexpected(pushed.error());
+            }
+            value.event = hash ? CursorEvent::BeginHash : CursorEvent::BeginArray;
+            value.size = size;
+            return value;
+        }
+        case ST_TABLE: {
+            auto table = BasicOSSP<Options>::ReadTable(&m_sr);
+            if (!table) {
+                return tl::unexpected(table.error());
+            }
+            auto pushed = Push(true, (uint32_t)table->fields * 2, table.value());
+            if (!pushed) {
+                return tl::unexpected(pushed.error());
+            }
+            value.event = CursorEvent::BeginHash;
+            value.size = table->fields;
+            value.layout = table->layout;
+            return value;
+        }
+        case ST_FLOAT64_ARRAY:
+        case ST_INT64_ARRAY: {
+            st_block_counter_t size;
+            if (!m_sr.ReadWithEndian(&size, endian) || m_sr.Remaining() / sizeof(uint64_t) < size) {
+                return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+            }
+            value.event = bin_type == ST_FLOAT64_ARRAY ? CursorEvent::Float64Array : CursorEvent::Int64Array;
+            value.size = size;
+            value.block = m_sr.Current();
+            m_sr.Skip((size_t)size * sizeof(uint64_t));
+            return value;
+        }
+        default:
+            break;
+    }
+
+    if (bin_type >= ST_ADV_BYTE_1 && bin_type <= ST_ADV_BYTE_8) {
+        if (!BasicOSSP<Options>::ReadCompactInt(&m_sr, bin_type - ST_ADV_BYTE_1 + 1, &value.integer)) {
+            return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+        }
+        value.event = CursorEvent::Int;
+        return value;
+    }
+    return make_OSSP_error(OSSPErrorInfoInvalidType, m_sr.CurrentReadingPos());
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicCursor<Options>::SkipValue() {
+    auto frame = Current();
+    if (frame == nullptr) {
+        return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+    }
+    if (m_sr.Remaining() > 0 && *m_sr.Current() == ST_TABLE) {
+        // the size of a table jumps over all of its entries, they are checked once they are read
+        m_sr.Skip(1);
+        auto table = BasicOSSP<Options>::ReadTable(&m_sr);
+        if (!table) {
+            return tl::unexpected(table.error());
+        }
+        m_sr.SetReadingPos(table->position + table->size);
+        frame->remaining--;
+        return {};
+    }
+    auto skipped = BasicOSSP<Options>::SkipValue(&m_sr, m_depth - 1);
+    if (skipped) {
+        frame->remaining--;
+    }
+    return skipped;
+}
+
+template <typename Options>
+tl::expected<st_counter_t, OSSPErrorInfo> BasicCursor<Options>::EnterHash() {
+    auto value = Next();
+    if (!value) {
+        return tl::unexpected(value.error());
+    }
+    if (value->event != CursorEvent::BeginHash) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, m_sr.CurrentReadingPos());
+    }
+    return (st_counter_t)value->size;
+}
+
+template <typename Options>
+tl::expected<st_counter_t, OSSPErrorInfo> BasicCursor<Options>::EnterArray() {
+    auto value = Next();
+    if (!value) {
+        return tl::unexpected(value.error());
+    }
+    if (value->event != CursorEvent::BeginArray) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, m_sr.CurrentReadingPos());
+    }
+    return (st_counter_t)value->size;
+}
+
+template <typename Options>
+tl::expected<bool, OSSPErrorInfo> BasicCursor<Options>::FindKey(std::string_view key) {
+    auto frame = Current();
+    if (frame == nullptr) {
+        return false;
+    }
+    if (!frame->hash || frame->remaining % 2 != 0) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, m_sr.CurrentReadingPos());
+    }
+    while (frame->remaining > 0) {
+        auto current = Next();
+        if (!current) {
+            return tl::unexpected(current.error());
+        }
+        bool named = current->event == CursorEvent::String || current->event == CursorEvent::Symbol;
+        if (named && current->string == key) {
+            return true;
+        }
+        auto skipped = SkipValue();
+        if (!skipped) {
+            return tl::unexpected(skipped.error());
+        }
+    }
+    return false;
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicCursor<Options>::SeekField(st_counter_t index) {
+    auto frame = &m_frames[m_depth - 1];
+    if (frame->table.position == 0) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, m_sr.CurrentReadingPos());
+    }
+    auto seeked = BasicOSSP<Options>::SeekTableEntry(&m_sr, frame->table, index);
+    if (seeked) {
+        frame->remaining = (uint32_t)(frame->table.fields - index) * 2;
+    }
+    return seeked;
+}
+
+template <typename Options>
+void BasicCursor<Options>::CopyBlock(const CursorValue& value, void* out) const {
+    if ((endian == Little) == SpanReader::HostIsLittleEndian()) {
+        memcpy(out, value.block, (size_t)value.size * sizeof(uint64_t));
+        return;
+    }
+    SpanReader block(value.block, (size_t)value.size * sizeof(uint64_t));
+    auto elements = (uint64_t*)out;
+    for (uint32_t i = 0; i < value.size; i++) {
+        block.ReadUnchecked(&elements[i], endian);
+    }
+}
+
+template <typename Options>
+std::string_view BasicCursor<Options>::MetaData() const {
+    return m_meta_data;
+}
+
+template <typename Options>
+uint16_t BasicCursor<Options>::Depth() const {
+    return m_depth - 1;
+}
+
+template <typename Options>
+size_t BasicCursor<Options>::Position() const {
+    return m_sr.CurrentReadingPos();
+}
+
+template <typename Options>
+typename BasicCursor<Options>::Frame* BasicCursor<Options>::Current() {
+    auto frame = &m_frames[m_depth - 1];
+    return frame->remaining > 0 ? frame : nullptr;
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicCursor<Options>::Push(bool hash, uint32_t remaining, const OSSPTable& table) {
+    if (m_depth > Options::max_depth) {
+        return make_OSSP_error(OSSPMaxDepthError, m_sr.CurrentReadingPos());
+    }
+    m_frames[m_depth++] = {remaining, hash, table};
+    return {};
+}
+
+template class BasicCursor<FeatureOptions<0>>;
+template class BasicCursor<FeatureOptions<FEATURE_COMPACT_INT>>;
+template class BasicCursor<FeatureOptions<FEATURE_NATIVE_ENDIAN>>;
+template class BasicCursor<FeatureOptions<FEATURE_CHECKSUM>>;
+template class BasicCursor<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN>>;
+template class BasicCursor<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_CHECKSUM>>;
+template class BasicCursor<FeatureOptions<FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM>>;
+template class BasicCursor<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM>>;
+
+}
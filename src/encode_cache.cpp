@@ -0,0 +1,122 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "ossp/encode_cache.h"
+
+#include "ossp/help.h"
+#include "ossp/ossp.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+EncodeCache::EncodeCache(mrb_state* mrb, size_t capacity, uint32_t max_idle) :
+    m_mrb(mrb), m_entries(capacity > 0 ? capacity : 1), m_max_idle(max_idle) {
+    m_objects = mrb_ary_new_capa(mrb, (mrb_int)m_entries.size());
+    mrb_gc_register(mrb, m_objects);
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        mrb_ary_set(mrb, m_objects, (mrb_int)i, mrb_nil_value());
+    }
+}
+
+EncodeCache::~EncodeCache() {
+    mrb_gc_unregister(m_mrb, m_objects);
+}
+
+void EncodeCache::Sweep() {
+    m_sweeps++;
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (!mrb_nil_p(RARRAY_PTR(m_objects)[i]) && m_sweeps - m_entries[i].last_used > m_max_idle) {
+            Drop(i);
+        }
+    }
+}
+
+void EncodeCache::Clear() {
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (!mrb_nil_p(RARRAY_PTR(m_objects)[i])) {
+            Drop(i);
+        }
+    }
+}
+
+size_t EncodeCache::Size() const {
+    return m_size;
+}
+
+size_t EncodeCache::Hits() const {
+    return m_hits;
+}
+
+size_t EncodeCache::Misses() const {
+    return m_misses;
+}
+
+bool EncodeCache::IsCandidate(mrb_value value) {
+    return (mrb_type(value) == MRB_TT_HASH || mrb_type(value) == MRB_TT_ARRAY) && MRB_FROZEN_P(mrb_basic_ptr(value));
+}
+
+const std::vector<uint8_t>* EncodeCache::Find(mrb_value container, uint64_t features, const EncodeOptions& options) {
+    auto slot = Slot(container);
+    auto& entry = m_entries[slot];
+    auto cached = RARRAY_PTR(m_objects)[slot];
+    if (mrb_nil_p(cached) || mrb_ptr(cached) != mrb_ptr(container) || entry.features != features ||
+        entry.records != options.records || entry.tables != options.tables) {
+        m_misses++;
+        return nullptr;
+    }
+    entry.last_used = m_sweeps;
+    m_hits++;
+    return &entry.bytes;
+}
+
+void EncodeCache::Store(mrb_value container, uint64_t features, const EncodeOptions& options, const uint8_t* bytes,
+                        size_t size) {
+    auto slot = Slot(container);
+    if (mrb_nil_p(RARRAY_PTR(m_objects)[slot])) {
+        m_size++;
+    }
+    mrb_ary_set(m_mrb, m_objects, (mrb_int)slot, container);
+    auto& entry = m_entries[slot];
+    entry.features = features;
+    entry.records = options.records;
+    entry.tables = options.tables;
+    entry.last_used = m_sweeps;
+    entry.bytes.assign(bytes, bytes + size);
+}
+
+size_t EncodeCache::Slot(mrb_value container) const {
+    // objects are at least 8 byte aligned, mix the rest like a Fibonacci hash
+    auto address = (uint64_t)(uintptr_t)mrb_ptr(container) >> 3;
+    return (size_t)((address * 0x9E3779B97F4A7C15ull) >> 32) % m_entries.size();
+}
+
+void EncodeCache::Drop(size_t slot) {
+    mrb_ary_set(m_mrb, m_objects, (mrb_int)slot, mrb_nil_value());
+    auto& entry = m_entries[slot];
+    entry.bytes.clear();
+    entry.bytes.shrink_to_fit();
+    m_size--;
+}
+
+}
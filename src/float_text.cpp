@@ -0,0 +1,474 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "ossp/float_text.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace lyniat::ossp::serialize::bin {
+
+struct CachedPower {
+    uint64_t f;
+    int e;
+    int k;
+};
+
+}
+
+#include "float_text_tables.cpp.inc"
+
+namespace lyniat::ossp::serialize::bin {
+
+static constexpr int mantissa_bits = 52;
+static constexpr uint64_t hidden_bit = uint64_t(1) << mantissa_bits;
+static constexpr int exponent_bias = 1023;
+
+static uint64_t DoubleBits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double BitsDouble(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// full 128 bit product of a and b
+static uint64_t Multiply(uint64_t a, uint64_t b, uint64_t* low) {
+#if defined(__SIZEOF_INT128__)
+    auto product = (unsigned __int128)a * b;
+    *low = (uint64_t)product;
+    return (uint64_t)(product >> 64);
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    uint64_t high;
+    *low = _umul128(a, b, &high);
+    return high;
+#else
+    uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+    uint64_t middle = (p0 >> 32) + (p1 & 0xFFFFFFFF) + (p2 & 0xFFFFFFFF);
+    *low = (middle << 32) | (p0 & 0xFFFFFFFF);
+    return p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+#endif
+}
+
+static int LeadingZeros(uint64_t value) {
+    // value != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(value);
+#else
+    int count = 0;
+    while ((value & (uint64_t(1) << 63)) == 0) {
+        value <<= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Formatting: Grisu2 as described by Florian Loitsch in "Printing Floating-Point Numbers Quickly
+// and Accurately with Integers". The boundaries of the rounding interval around the value are scaled
+// by a cached power of ten into [2^-60, 2^-32) so all digits come out of 64 bit integer arithmetic.
+
+// f * 2^e
+struct DiyFp {
+    uint64_t f;
+    int e;
+};
+
+static DiyFp Sub(DiyFp x, DiyFp y) {
+    return {x.f - y.f, x.e};
+}
+
+// product rounded to the upper 64 bits
+static DiyFp Mul(DiyFp x, DiyFp y) {
+    uint64_t low;
+    auto high = Multiply(x.f, y.f, &low);
+    return {high + (low >> 63), x.e + y.e + 64};
+}
+
+static DiyFp Normalize(DiyFp x) {
+    auto shift = LeadingZeros(x.f);
+    return {x.f << shift, x.e - shift};
+}
+
+static constexpr int grisu_alpha = -60;
+
+static const CachedPower& GetCachedPower(int e) {
+    // the smallest k with e + e(10^-k) + 64 >= alpha, then the first table entry at or above it
+    int f = grisu_alpha - e - 1;
+    int k = (f * 78913) / (1 << 18) + (f > 0 ? 1 : 0);
+    int index = (300 + k + 7) / 8;
+    return cached_powers[index];
+}
+
+static int LargestPow10(uint32_t n, uint32_t* pow10) {
+    static const uint32_t powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+                                      1000000000};
+    int digits = 10;
+    while (digits > 1 && n < powers[digits - 1]) {
+        digits--;
+    }
+    *pow10 = powers[digits - 1];
+    return digits;
+}
+
+// moves the last digit towards the value while it stays inside the interval
+static void RoundWeed(char* digits, int length, uint64_t distance, uint64_t delta, uint64_t rest,
+                      uint64_t ten_k) {
+    while (rest < distance && delta - rest >= ten_k &&
+           (rest + ten_k < distance || distance - rest > rest + ten_k - distance)) {
+        digits[length - 1]--;
+        rest += ten_k;
+    }
+}
+
+static void GenerateDigits(char* digits, int* length, int* exponent, DiyFp low, DiyFp value, DiyFp high) {
+    auto delta = Sub(high, low);
+    auto distance = Sub(high, value);
+    const int shift = -high.e;
+    const uint64_t one = uint64_t(1) << shift;
+    auto integral = (uint32_t)(high.f >> shift);
+    auto fraction = high.f & (one - 1);
+
+    uint32_t pow10;
+    int n = LargestPow10(integral, &pow10);
+    while (n > 0) {
+        digits[(*length)++] = (char)('0' + integral / pow10);
+        integral %= pow10;
+        n--;
+        auto rest = ((uint64_t)integral << shift) + fraction;
+        if (rest <= delta.f) {
+            *exponent += n;
+            RoundWeed(digits, *length, distance.f, delta.f, rest, (uint64_t)pow10 << shift);
+            return;
+        }
+        pow10 /= 10;
+    }
+
+    int m = 0;
+    while (true) {
+        fraction *= 10;
+        digits[(*length)++] = (char)('0' + (fraction >> shift));
+        fraction &= one - 1;
+        m++;
+        delta.f *= 10;
+        distance.f *= 10;
+        if (fraction <= delta.f) {
+            break;
+        }
+    }
+    *exponent -= m;
+    RoundWeed(digits, *length, distance.f, delta.f, fraction, one);
+}
+
+// value > 0 and finite, digits * 10^exponent
+static void Grisu2(double value, char* digits, int* length, int* exponent) {
+    auto bits = DoubleBits(value);
+    auto biased = (int)(bits >> mantissa_bits);
+    auto fraction = bits & (hidden_bit - 1);
+    DiyFp v = biased == 0 ? DiyFp{fraction, 1 - exponent_bias - mantissa_bits}
+                          : DiyFp{fraction + hidden_bit, biased - exponent_bias - mantissa_bits};
+
+    // halfway to the neighbours, the lower one is closer when value is a power of two
+    auto plus = Normalize({2 * v.f + 1, v.e - 1});
+    DiyFp minus = (fraction == 0 && biased > 1) ? DiyFp{4 * v.f - 1, v.e - 2} : DiyFp{2 * v.f - 1, v.e - 1};
+    minus = {minus.f << (minus.e - plus.e), plus.e};
+    v = Normalize(v);
+
+    auto& cached = GetCachedPower(plus.e);
+    DiyFp c = {cached.f, cached.e};
+    auto w = Mul(v, c);
+    auto w_minus = Mul(minus, c);
+    auto w_plus = Mul(plus, c);
+    // the products may be off by one, stay safely inside
+    w_minus.f++;
+    w_plus.f--;
+
+    *length = 0;
+    *exponent = -cached.k;
+    GenerateDigits(digits, length, exponent, w_minus, w, w_plus);
+}
+
+static char* WriteExponent(char* p, int exponent) {
+    *p++ = 'e';
+    if (exponent < 0) {
+        *p++ = '-';
+        exponent = -exponent;
+    } else {
+        *p++ = '+';
+    }
+    if (exponent >= 100) {
+        *p++ = (char)('0' + exponent / 100);
+        exponent %= 100;
+    }
+    *p++ = (char)('0' + exponent / 10);
+    *p++ = (char)('0' + exponent % 10);
+    return p;
+}
+
+char* format_float(double value, char* buffer) {
+    auto bits = DoubleBits(value);
+    auto p = buffer;
+    if (((bits >> mantissa_bits) & 0x7FF) == 0x7FF) {
+        const char* text = (bits & (hidden_bit - 1)) != 0 ? "nan" : (bits >> 63) != 0 ? "-inf" : "inf";
+        auto length = strlen(text);
+        memcpy(p, text, length);
+        return p + length;
+    }
+    if ((bits >> 63) != 0) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value == 0) {
+        memcpy(p, "0.0", 3);
+        return p + 3;
+    }
+
+    int length;
+    int exponent;
+    Grisu2(value, p, &length, &exponent);
+
+    // position of the decimal point relative to the first digit
+    int point = length + exponent;
+    if (length <= point && point <= 15) {
+        // digits[000].0
+        memset(p + length, '0', point - length);
+        p[point] = '.';
+        p[point + 1] = '0';
+        return p + point + 2;
+    }
+    if (0 < point && point <= 15) {
+        // dig.its
+        memmove(p + point + 1, p + point, length - point);
+        p[point] = '.';
+        return p + length + 1;
+    }
+    if (-4 < point && point <= 0) {
+        // 0.[000]digits
+        memmove(p + 2 - point, p, length);
+        p[0] = '0';
+        p[1] = '.';
+        memset(p + 2, '0', -point);
+        return p + 2 - point + length;
+    }
+    // d[.igits]e+xx
+    if (length == 1) {
+        p += 1;
+    } else {
+        memmove(p + 2, p + 1, length - 1);
+        p[1] = '.';
+        p += length + 1;
+    }
+    return WriteExponent(p, point - 1);
+}
+
+// Parsing: the Clinger fast path for values that are exact in double arithmetic, otherwise
+// Eisel-Lemire as in Daniel Lemire's "Number Parsing at a Gigabyte per Second": the decimal mantissa
+// times a 128 bit approximation of 5^q already decides the rounding for every mantissa of up to 19 digits.
+
+static constexpr int min_power_of_ten = -342;
+static constexpr int max_power_of_ten = 308;
+
+// biased exponent and mantissa bits (without the hidden bit) of w * 10^q, w != 0
+static void EiselLemire(uint64_t w, int64_t q, uint64_t* mantissa, int* power2) {
+    if (q < min_power_of_ten) {
+        *mantissa = 0;
+        *power2 = 0;
+        return;
+    }
+    if (q > max_power_of_ten) {
+        *mantissa = 0;
+        *power2 = 0x7FF;
+        return;
+    }
+    int zeros = LeadingZeros(w);
+    w <<= zeros;
+
+    auto index = 2 * (size_t)(q - min_power_of_ten);
+    uint64_t low;
+    auto high = Multiply(w, powers_of_five[index], &low);
+    // only the upper 55 bits matter, refine with the lower half of 5^q when they could still change
+    constexpr uint64_t precision_mask = ~uint64_t(0) >> (mantissa_bits + 3);
+    if ((high & precision_mask) == precision_mask) {
+        uint64_t second_low;
+        auto second_high = Multiply(w, powers_of_five[index + 1], &second_low);
+        low += second_high;
+        if (second_high > low) {
+            high++;
+        }
+    }
+
+    int upper_bit = (int)(high >> 63);
+    int shift = upper_bit + 64 - mantissa_bits - 3;
+    uint64_t m = high >> shift;
+    // floor(log2(10^q)) + 63, the product's exponent
+    int p = (int)((((152170 + 65536) * (int32_t)q) >> 16) + 63) + upper_bit - zeros + exponent_bias;
+
+    if (p <= 0) {
+        // subnormal
+        if (-p + 1 >= 64) {
+            *mantissa = 0;
+            *power2 = 0;
+            return;
+        }
+        m >>= -p + 1;
+        m += m & 1;
+        m >>= 1;
+        *power2 = m < hidden_bit ? 0 : 1;
+        *mantissa = m & (hidden_bit - 1);
+        return;
+    }
+
+    // an exact halfway product only happens for small q, round it to even
+    if (low <= 1 && q >= -4 && q <= 23 && (m & 3) == 1 && (m << shift) == high) {
+        m &= ~uint64_t(1);
+    }
+    m += m & 1;
+    m >>= 1;
+    if (m >= (hidden_bit << 1)) {
+        m = hidden_bit;
+        p++;
+    }
+    m &= hidden_bit - 1;
+    if (p >= 0x7FF) {
+        p = 0x7FF;
+        m = 0;
+    }
+    *mantissa = m;
+    *power2 = p;
+}
+
+static double ToDouble(bool negative, uint64_t mantissa, int power2) {
+    return BitsDouble(((uint64_t)negative << 63) | ((uint64_t)power2 << mantissa_bits) | mantissa);
+}
+
+const char* parse_float(const char* first, const char* last, double* value) {
+    auto p = first;
+    bool negative = p < last && *p == '-';
+    if (negative) {
+        p++;
+    }
+
+    // the first 19 significant digits, the rest only moves the exponent or is dropped
+    uint64_t w = 0;
+    int significant = 0;
+    int64_t exponent = 0;
+    bool truncated = false;
+    bool any_digit = false;
+    bool fraction = false;
+    while (p < last) {
+        if (*p == '.' && !fraction) {
+            fraction = true;
+            p++;
+            continue;
+        }
+        unsigned digit = (unsigned char)*p - '0';
+        if (digit > 9) {
+            break;
+        }
+        any_digit = true;
+        if (w == 0 && digit == 0) {
+            exponent -= fraction;
+        } else if (significant < 19) {
+            w = w * 10 + digit;
+            significant++;
+            exponent -= fraction;
+        } else {
+            exponent += !fraction;
+            truncated |= digit != 0;
+        }
+        p++;
+    }
+    if (!any_digit) {
+        return nullptr;
+    }
+
+    if (p < last && (*p == 'e' || *p == 'E')) {
+        auto e = p + 1;
+        bool negative_exponent = e < last && *e == '-';
+        if (e < last && (*e == '-' || *e == '+')) {
+            e++;
+        }
+        if (e < last && *e >= '0' && *e <= '9') {
+            int64_t explicit_exponent = 0;
+            while (e < last && *e >= '0' && *e <= '9') {
+                // anything this large is zero or infinity anyway
+                if (explicit_exponent < 100000) {
+                    explicit_exponent = explicit_exponent * 10 + (*e - '0');
+                }
+                e++;
+            }
+            exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+            p = e;
+        }
+        // a lone e is not part of the number
+    }
+
+    if (w == 0) {
+        *value = negative ? -0.0 : 0.0;
+        return p;
+    }
+
+    // w and 10^|q| are both exact doubles, so a single operation rounds correctly
+    static const double exact_powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (!truncated && w <= hidden_bit << 1 && exponent >= -22 && exponent <= 22) {
+        auto result = (double)w;
+        result = exponent < 0 ? result / exact_powers[-exponent] : result * exact_powers[exponent];
+        *value = negative ? -result : result;
+        return p;
+    }
+
+    uint64_t mantissa;
+    int power2;
+    EiselLemire(w, exponent, &mantissa, &power2);
+    if (truncated) {
+        // the real mantissa lies between w and w + 1, if both round the same way so does it
+        uint64_t upper_mantissa;
+        int upper_power2;
+        EiselLemire(w + 1, exponent, &upper_mantissa, &upper_power2);
+        if (upper_mantissa != mantissa || upper_power2 != power2) {
+            // strtod needs a terminated copy
+            std::string number(first, p - first);
+            *value = strtod(number.c_str(), nullptr);
+            return p;
+        }
+    }
+    *value = ToDouble(negative, mantissa, power2);
+    return p;
+}
+
+}
@@ -0,0 +1,786 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/json.h"
+
+#include "ossp/float_text.h"
+#include "ossp/help.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define OSSP_JSON_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+namespace lyniat::ossp::serialize::bin {
+
+static constexpr uint64_t RepeatByte(uint8_t byte) {
+    return 0x0101010101010101ULL * byte;
+}
+
+// both are exact for "any byte", not for telling which one
+static bool HasZeroByte(uint64_t word) {
+    return ((word - RepeatByte(0x01)) & ~word & RepeatByte(0x80)) != 0;
+}
+
+static bool HasByteBelow(uint64_t word, uint8_t limit) {
+    return ((word - RepeatByte(limit)) & ~word & RepeatByte(0x80)) != 0;
+}
+
+static bool IsJSONSpecial(uint8_t c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+#ifdef OSSP_JSON_SSE2
+static unsigned CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+size_t find_JSON_special(const char* data, size_t size) {
+    size_t i = 0;
+#ifdef OSSP_JSON_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= size; i += 16) {
+        auto chunk = _mm_loadu_si128((const __m128i*)(data + i));
+        // there is no unsigned compare, but c <= 0x1F is the same as max(c, 0x1F) == 0x1F
+        auto special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                    _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+        auto mask = (uint32_t)_mm_movemask_epi8(special);
+        if (mask != 0) {
+            return i + CountTrailingZeros(mask);
+        }
+    }
+#endif
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(uint64_t));
+        if (HasByteBelow(word, 0x20) || HasZeroByte(word ^ RepeatByte('"')) || HasZeroByte(word ^ RepeatByte('\\'))) {
+            break;
+        }
+    }
+    for (; i < size; i++) {
+        if (IsJSONSpecial((uint8_t)data[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+bool is_valid_UTF8(const char* data, size_t size) {
+    auto bytes = (const uint8_t*)data;
+    size_t i = 0;
+    while (i < size) {
+#ifdef OSSP_JSON_SSE2
+        while (i + 16 <= size && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(bytes + i))) == 0) {
+            i += 16;
+        }
+#endif
+        while (i + sizeof(uint64_t) <= size) {
+            uint64_t word;
+            memcpy(&word, bytes + i, sizeof(uint64_t));
+            if ((word & RepeatByte(0x80)) != 0) {
+                break;
+            }
+            i += sizeof(uint64_t);
+        }
+        if (i == size) {
+            break;
+        }
+        if (bytes[i] < 0x80) {
+            i++;
+            continue;
+        }
+
+        auto lead = bytes[i];
+        size_t length;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+        } else {
+            // continuation bytes, the overlong leads 0xC0 and 0xC1 and everything above 0xF4
+            return false;
+        }
+        if (size - i < length) {
+            return false;
+        }
+        uint32_t code_point = lead & (0x7F >> length);
+        for (size_t k = 1; k < length; k++) {
+            if ((bytes[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+            code_point = (code_point << 6) | (bytes[i + k] & 0x3F);
+        }
+        if (length == 3 && (code_point < 0x800 || (code_point >= 0xD800 && code_point <= 0xDFFF))) {
+            return false;
+        }
+        if (length == 4 && (code_point < 0x10000 || code_point > 0x10FFFF)) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+static void AppendText(ByteBuffer* bb, std::string_view text) {
+    bb->Append((char*)text.data(), text.size());
+}
+
+static void AppendEscaped(ByteBuffer* bb, uint8_t c) {
+    switch (c) {
+        case '"': AppendText(bb, "\\\""); return;
+        case '\\': AppendText(bb, "\\\\"); return;
+        case '\b': AppendText(bb, "\\b"); return;
+        case '\f': AppendText(bb, "\\f"); return;
+        case '\n': AppendText(bb, "\\n"); return;
+        case '\r': AppendText(bb, "\\r"); return;
+        case '\t': AppendText(bb, "\\t"); return;
+        default: break;
+    }
+    static constexpr char hex[] = "0123456789abcdef";
+    char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+    bb->Append(escaped, sizeof(escaped));
+}
+
+void append_JSON_string(ByteBuffer* bb, std::string_view data) {
+    AppendText(bb, "\"");
+    size_t pos = 0;
+    while (pos < data.size()) {
+        auto run = find_JSON_special(data.data() + pos, data.size() - pos);
+        if (run > 0) {
+            bb->Append((char*)data.data() + pos, run);
+            pos += run;
+        }
+        if (pos < data.size()) {
+            AppendEscaped(bb, (uint8_t)data[pos]);
+            pos++;
+        }
+    }
+    AppendText(bb, "\"");
+}
+
+void append_JSON_int(ByteBuffer* bb, int64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    bb->Append(digits, result.ptr - digits);
+}
+
+void append_JSON_float(ByteBuffer* bb, double value) {
+    if (!std::isfinite(value)) {
+        AppendText(bb, "null");
+        return;
+    }
+    char digits[float_text_max_size];
+    auto end = format_float(value, digits);
+    bb->Append(digits, end - digits);
+}
+
+JSONReader::JSONReader(const uint8_t* data, size_t size) : m_sr(data, size), m_frames(), m_depth(1) {
+    // the top level is a container of exactly one value
+    m_frames[0] = {false, State::First};
+}
+
+JSONReader::JSONReader(ReadBuffer* rb) : m_sr(rb), m_frames(), m_depth(1) {
+    m_frames[0] = {false, State::First};
+}
+
+tl::expected<CursorValue, OSSPErrorInfo> JSONReader::Next() {
+    CursorValue value = {};
+    auto frame = &m_frames[m_depth - 1];
+    SkipWhitespace();
+
+    if (m_depth == 1) {
+        if (frame->state == State::Done) {
+            if (m_sr.Remaining() != 0) {
+                return make_OSSP_error(OSSPUnexpectedDataError, m_sr.CurrentReadingPos());
+            }
+            value.event = CursorEvent::End;
+            return value;
+        }
+        frame->state = State::Done;
+        return ReadValue(value);
+    }
+
+    if (m_sr.Remaining() == 0) {
+        return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+    }
+    if (frame->state == State::First || frame->state == State::Done) {
+        auto c = *m_sr.Current();
+        if (c == (frame->object ? '}' : ']')) {
+            m_sr.Skip(1);
+            m_depth--;
+            value.event = CursorEvent::End;
+            return value;
+        }
+        if (frame->state == State::Done) {
+            if (c != ',') {
+                return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+            }
+            m_sr.Skip(1);
+            SkipWhitespace();
+        }
+        frame->state = frame->object ? State::Key : State::Value;
+    }
+
+    if (frame->state == State::Key) {
+        if (m_sr.Remaining() == 0 || *m_sr.Current() != '"') {
+            return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+        }
+        m_sr.Skip(1);
+        auto key = ReadString();
+        if (!key) {
+            return tl::unexpected(key.error());
+        }
+        SkipWhitespace();
+        if (m_sr.Remaining() == 0 || *m_sr.Current() != ':') {
+            return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+        }
+        m_sr.Skip(1);
+        frame->state = State::Value;
+        value.event = CursorEvent::String;
+        value.key = true;
+        value.string = key.value();
+        return value;
+    }
+
+    frame->state = State::Done;
+    return ReadValue(value);
+}
+
+tl::expected<void, OSSPErrorInfo> JSONReader::SkipValue() {
+    auto depth = m_depth;
+    auto value = Next();
+    while (value && m_depth > depth) {
+        value = Next();
+    }
+    if (!value) {
+        return tl::unexpected(value.error());
+    }
+    return {};
+}
+
+uint16_t JSONReader::Depth() const {
+    return m_depth - 1;
+}
+
+size_t JSONReader::Position() const {
+    return m_sr.CurrentReadingPos();
+}
+
+void JSONReader::SkipWhitespace() {
+    while (m_sr.Remaining() > 0) {
+        auto c = *m_sr.Current();
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            return;
+        }
+        m_sr.Skip(1);
+    }
+}
+
+tl::expected<CursorValue, OSSPErrorInfo> JSONReader::ReadValue(CursorValue value) {
+    SkipWhitespace();
+    if (m_sr.Remaining() == 0) {
+        return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+    }
+    auto c = *m_sr.Current();
+    switch (c) {
+        case '{':
+        case '[':
+            if (m_depth > max_depth) {
+                return make_OSSP_error(OSSPMaxDepthError, m_sr.CurrentReadingPos());
+            }
+            m_sr.Skip(1);
+            m_frames[m_depth++] = {c == '{', State::First};
+            value.event = c == '{' ? CursorEvent::BeginHash : CursorEvent::BeginArray;
+            return value;
+        case '"': {
+            m_sr.Skip(1);
+            auto string = ReadString();
+            if (!string) {
+                return tl::unexpected(string.error());
+            }
+            value.event = CursorEvent::String;
+            value.string = string.value();
+            return value;
+        }
+        case 't':
+        case 'f':
+            if (ReadLiteral(c == 't' ? "true" : "false")) {
+                value.event = CursorEvent::Bool;
+                value.boolean = c == 't';
+                return value;
+            }
+            break;
+        case 'n':
+            if (ReadLiteral("null")) {
+                value.event = CursorEvent::Nil;
+                return value;
+            }
+            break;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                auto number = ReadNumber(&value);
+                if (!number) {
+                    return tl::unexpected(number.error());
+                }
+                return value;
+            }
+            break;
+    }
+    return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+}
+
+tl::expected<std::string_view, OSSPErrorInfo> JSONReader::ReadString() {
+    // the opening quote is already consumed
+    auto start = (const char*)m_sr.Current();
+    auto run = find_JSON_special(start, m_sr.Remaining());
+    if (run == m_sr.Remaining()) {
+        return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+    }
+    if (start[run] == '"') {
+        m_sr.Skip(run + 1);
+        return std::string_view(start, run);
+    }
+
+    m_scratch.assign(start, run);
+    m_sr.Skip(run);
+    while (true) {
+        if (m_sr.Remaining() == 0) {
+            return make_OSSP_error(OSSPReadingError, m_sr.CurrentReadingPos());
+        }
+        auto c = *m_sr.Current();
+        if (c == '"') {
+            m_sr.Skip(1);
+            return std::string_view(m_scratch);
+        }
+        // raw control characters are not allowed in strings
+        if (c != '\\' || m_sr.Remaining() < 2) {
+            return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+        }
+        auto escaped = m_sr.Current()[1];
+        m_sr.Skip(2);
+        switch (escaped) {
+            case '"': m_scratch += '"'; break;
+            case '\\': m_scratch += '\\'; break;
+            case '/': m_scratch += '/'; break;
+            case 'b': m_scratch += '\b'; break;
+            case 'f': m_scratch += '\f'; break;
+            case 'n': m_scratch += '\n'; break;
+            case 'r': m_scratch += '\r'; break;
+            case 't': m_scratch += '\t'; break;
+            case 'u':
+                if (ReadUnicodeEscape()) {
+                    break;
+                }
+                // fall through
+            default:
+                return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+        }
+        auto next = (const char*)m_sr.Current();
+        run = find_JSON_special(next, m_sr.Remaining());
+        m_scratch.append(next, run);
+        m_sr.Skip(run);
+    }
+}
+
+static bool ReadHex4(SpanReader* sr, uint32_t* value) {
+    if (sr->Remaining() < 4) {
+        return false;
+    }
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        auto c = sr->Current()[i];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        *value = (*value << 4) | digit;
+    }
+    sr->Skip(4);
+    return true;
+}
+
+bool JSONReader::ReadUnicodeEscape() {
+    uint32_t code_point;
+    if (!ReadHex4(&m_sr, &code_point) || (code_point >= 0xDC00 && code_point <= 0xDFFF)) {
+        return false;
+    }
+    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+        // characters outside the BMP are written as a surrogate pair
+        uint32_t low;
+        if (m_sr.Remaining() < 2 || m_sr.Current()[0] != '\\' || m_sr.Current()[1] != 'u') {
+            return false;
+        }
+        m_sr.Skip(2);
+        if (!ReadHex4(&m_sr, &low) || low < 0xDC00 || low > 0xDFFF) {
+            return false;
+        }
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    if (code_point < 0x80) {
+        m_scratch += (char)code_point;
+    } else if (code_point < 0x800) {
+        m_scratch += (char)(0xC0 | (code_point >> 6));
+        m_scratch += (char)(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        m_scratch += (char)(0xE0 | (code_point >> 12));
+        m_scratch += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        m_scratch += (char)(0x80 | (code_point & 0x3F));
+    } else {
+        m_scratch += (char)(0xF0 | (code_point >> 18));
+        m_scratch += (char)(0x80 | ((code_point >> 12) & 0x3F));
+        m_scratch += (char)(0x80 | ((code_point >> 6) & 0x3F));
+        m_scratch += (char)(0x80 | (code_point & 0x3F));
+    }
+    return true;
+}
+
+static const char* SkipDigits(const char* p, const char* end) {
+    while (p < end && *p >= '0' && *p <= '9') {
+        p++;
+    }
+    return p;
+}
+
+tl::expected<void, OSSPErrorInfo> JSONReader::ReadNumber(CursorValue* value) {
+    auto start = (const char*)m_sr.Current();
+    auto end = start + m_sr.Remaining();
+    auto p = start;
+    if (*p == '-') {
+        p++;
+    }
+    // no leading zeros, no empty fraction or exponent
+    auto digits = p;
+    p = (p < end && *p == '0') ? p + 1 : SkipDigits(p, end);
+    if (p == digits) {
+        return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+    }
+    bool integer = true;
+    if (p < end && *p == '.') {
+        digits = ++p;
+        p = SkipDigits(p, end);
+        integer = false;
+        if (p == digits) {
+            return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        digits = p;
+        p = SkipDigits(p, end);
+        integer = false;
+        if (p == digits) {
+            return make_OSSP_error(OSSPInvalidJSONError, m_sr.CurrentReadingPos());
+        }
+    }
+
+    if (integer) {
+        auto result = std::from_chars(start, p, value->integer);
+        if (result.ec == std::errc()) {
+            value->event = CursorEvent::Int;
+            m_sr.Skip(p - start);
+            return {};
+        }
+        // too large for an Integer, mRuby has no Bignum so it becomes a Float
+    }
+
+    value->event = CursorEvent::Float;
+    parse_float(start, p, &value->number);
+    m_sr.Skip(p - start);
+    return {};
+}
+
+bool JSONReader::ReadLiteral(std::string_view literal) {
+    if (m_sr.Remaining() < literal.size() || memcmp(m_sr.Current(), literal.data(), literal.size()) != 0) {
+        return false;
+    }
+    m_sr.Skip(literal.size());
+    return true;
+}
+
+void JSON::Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options) {
+    SerializeRecursive(bb, mrb, data, options);
+}
+
+tl::expected<mrb_value, OSSPErrorInfo> JSON::Deserialize(ReadBuffer* rb, mrb_state* mrb, const DecodeOptions& options) {
+    JSONReader reader(rb);
+    auto value = reader.Next();
+    if (!value) {
+        return tl::unexpected(value.error());
+    }
+    auto decoded = DecodeValue(&reader, value.value(), mrb, options);
+    if (!decoded) {
+        return decoded;
+    }
+    // only whitespace may follow
+    auto end = reader.Next();
+    if (!end) {
+        return tl::unexpected(end.error());
+    }
+    return decoded;
+}
+
+void JSON::SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options) {
+    if (options.records != nullptr) {
+        auto record = options.records->Find(data);
+        if (record != nullptr) {
+            AppendText(bb, "{");
+            for (size_t i = 0; i < record->keys.size(); i++) {
+                if (i > 0) {
+                    AppendText(bb, ",");
+                }
+                AddKey(bb, mrb, mrb_symbol_value(record->keys[i]));
+                SerializeRecursive(bb, mrb, mrb_iv_get(mrb, data, record->ivars[i]), options);
+            }
+            AppendText(bb, "}");
+            return;
+        }
+    }
+    if (get_OSSP_tracked(data) != nullptr) {
+        SerializeRecursive(bb, mrb, get_OSSP_tracked_data(mrb, data), options);
+        return;
+    }
+    auto typed_array = get_OSSP_typed_array(data);
+    if (typed_array != nullptr) {
+        AppendText(bb, "[");
+        for (size_t i = 0; i < typed_array->size; i++) {
+            if (i > 0) {
+                AppendText(bb, ",");
+            }
+            if (typed_array->type == TypedArrayType::Float64) {
+                append_JSON_float(bb, ((const double*)typed_array->data)[i]);
+            } else {
+                append_JSON_int(bb, ((const int64_t*)typed_array->data)[i]);
+            }
+        }
+        AppendText(bb, "]");
+        return;
+    }
+
+    switch (OSSP::GetType(data)) {
+        case ST_FALSE:
+            AppendText(bb, "false");
+            return;
+        case ST_TRUE:
+            AppendText(bb, "true");
+            return;
+        case ST_INT:
+            append_JSON_int(bb, cext_to_int(mrb, data));
+            return;
+        case ST_FLOAT:
+            append_JSON_float(bb, cext_to_float(mrb, data));
+            return;
+        case ST_STRING:
+            append_JSON_string(bb, std::string_view(RSTRING_PTR(data), RSTRING_LEN(data)));
+            return;
+        case ST_SYMBOL: {
+            mrb_int len;
+            auto name = mrb_sym_name_len(mrb, mrb_symbol(data), &len);
+            append_JSON_string(bb, std::string_view(name, len));
+            return;
+        }
+        case ST_ARRAY: {
+            AppendText(bb, "[");
+            mrb_int array_size = RARRAY_LEN(data);
+            for (mrb_int i = 0; i < array_size; i++) {
+                if (i > 0) {
+                    AppendText(bb, ",");
+                }
+                SerializeRecursive(bb, mrb, RARRAY_PTR(data)[i], options);
+            }
+            AppendText(bb, "]");
+            return;
+        }
+        case ST_HASH: {
+            AppendText(bb, "{");
+            typedef struct to_pass_t {
+                ByteBuffer* buffer;
+                const EncodeOptions* options;
+                bool first;
+            } to_pass_t;
+            to_pass_t to_pass = {bb, &options, true};
+
+            mrb_hash_foreach(mrb, mrb_hash_ptr(data), {[](mrb_state* intern_state, mrb_value key, mrb_value val, void* passed) -> int {
+                auto to_pass = (to_pass_t*)passed;
+                auto key_type = OSSP::GetType(key);
+                if (key_type != ST_STRING && key_type != ST_SYMBOL && key_type != ST_INT && key_type != ST_FLOAT) {
+                    return 0;
+                }
+                if (!to_pass->first) {
+                    AppendText(to_pass->buffer, ",");
+                }
+                to_pass->first = false;
+                AddKey(to_pass->buffer, intern_state, key);
+                SerializeRecursive(to_pass->buffer, intern_state, val, *to_pass->options);
+                return 0;
+            }}, &to_pass);
+            AppendText(bb, "}");
+            return;
+        }
+        default:
+            AppendText(bb, "null");
+            return;
+    }
+}
+
+void JSON::AddKey(ByteBuffer* bb, mrb_state* mrb, mrb_value key) {
+    // object keys are always strings in JSON, numbers get quoted
+    auto key_type = OSSP::GetType(key);
+    if (key_type == ST_INT) {
+        AppendText(bb, "\"");
+        append_JSON_int(bb, cext_to_int(mrb, key));
+        AppendText(bb, "\"");
+    } else if (key_type == ST_FLOAT) {
+        AppendText(bb, "\"");
+        append_JSON_float(bb, cext_to_float(mrb, key));
+        AppendText(bb, "\"");
+    } else {
+        SerializeRecursive(bb, mrb, key, {});
+    }
+    AppendText(bb, ":");
+}
+
+tl::expected<mrb_value, OSSPErrorInfo> JSON::DecodeValue(JSONReader* reader, const CursorValue& value, mrb_state* mrb,
+                                                         const DecodeOptions& options) {
+    switch (value.event) {
+        case CursorEvent::Nil:
+            return mrb_nil_value();
+        case CursorEvent::Bool:
+            return mrb_bool_value(value.boolean);
+        case CursorEvent::Int:
+            return mrb_int_value(mrb, (mrb_int)value.integer);
+        case CursorEvent::Float:
+            return mrb_float_value(mrb, value.number);
+        case CursorEvent::String:
+            return DecodeString(value.string, mrb, options);
+        case CursorEvent::BeginHash:
+            return DecodeObject(reader, mrb, options);
+        case CursorEvent::BeginArray: {
+            mrb_value array = mrb_ary_new_capa(mrb, 0);
+            for (mrb_int i = 0;; i++) {
+                auto next = reader->Next();
+                if (!next) {
+                    return tl::unexpected(next.error());
+                }
+                if (next->event == CursorEvent::End) {
+                    return array;
+                }
+                auto element = DecodeValue(reader, next.value(), mrb, options);
+                if (!element) {
+                    return element;
+                }
+                mrb_ary_set(mrb, array, i, element.value());
+            }
+        }
+        default:
+            return make_OSSP_error(OSSPInvalidJSONError, reader->Position());
+    }
+}
+
+tl::expected<mrb_value, OSSPErrorInfo> JSON::DecodeObject(JSONReader* reader, mrb_state* mrb, const DecodeOptions& options) {
+    // with records the entries are collected first, as in BasicOSSP::DecodeRecord
+    std::vector<mrb_value> entries;
+    mrb_value hash = mrb_hash_new(mrb);
+    while (true) {
+        auto key = reader->Next();
+        if (!key) {
+            return tl::unexpected(key.error());
+        }
+        if (key->event == CursorEvent::End) {
+            break;
+        }
+        // the key may point into the buffer of the reader, so it has to become an object before the value is read
+        mrb_value key_value;
+        if (options.keys == KeyConversion::Symbolize) {
+            key_value = mrb_symbol_value(mrb_intern(mrb, key->string.data(), key->string.size()));
+        } else {
+            key_value = DecodeString(key->string, mrb, options);
+        }
+        auto next = reader->Next();
+        if (!next) {
+            return tl::unexpected(next.error());
+        }
+        auto value = DecodeValue(reader, next.value(), mrb, options);
+        if (!value) {
+            return value;
+        }
+        if (options.records != nullptr) {
+            entries.push_back(key_value);
+            entries.push_back(value.value());
+        } else {
+            mrb_hash_set(mrb, hash, key_value, value.value());
+        }
+    }
+
+    if (options.records == nullptr) {
+        return hash;
+    }
+    auto size = entries.size() / 2;
+    if (options.records->MayMatch(size)) {
+        auto record = options.records->Materialize(mrb, entries.data(), size);
+        if (!mrb_nil_p(record)) {
+            return record;
+        }
+    }
+    for (size_t i = 0; i < size; i++) {
+        mrb_hash_set(mrb, hash, entries[i * 2], entries[i * 2 + 1]);
+    }
+    return hash;
+}
+
+mrb_value JSON::DecodeString(std::string_view string, mrb_state* mrb, const DecodeOptions& options) {
+    if (options.strings != nullptr) {
+        return options.strings->Get(mrb, string.data(), string.size());
+    }
+    return mrb_str_new(mrb, string.data(), string.size());
+}
+
+}
@@ -0,0 +1,603 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "ossp/msgpack.h"
+
+#include "ossp/help.h"
+#include "ossp/tracked.h"
+#include "ossp/typed_array.h"
+#include <vector>
+
+namespace lyniat::ossp::serialize::bin {
+
+void append_MessagePack_nil(ByteBuffer* bb) {
+    bb->AppendWithEndian((uint8_t)0xc0, Big);
+}
+
+void append_MessagePack_bool(ByteBuffer* bb, bool value) {
+    bb->AppendWithEndian((uint8_t)(value ? 0xc3 : 0xc2), Big);
+}
+
+void append_MessagePack_int(ByteBuffer* bb, int64_t value) {
+    if (value >= -32 && value <= 127) {
+        // positive and negative fixint
+        bb->AppendWithEndian((uint8_t)(int8_t)value, Big);
+    } else if (value > 0) {
+        if (value <= UINT8_MAX) {
+            bb->AppendWithEndian((uint8_t)0xcc, Big);
+            bb->AppendWithEndian((uint8_t)value, Big);
+        } else if (value <= UINT16_MAX) {
+            bb->AppendWithEndian((uint8_t)0xcd, Big);
+            bb->AppendWithEndian((uint16_t)value, Big);
+        } else if (value <= UINT32_MAX) {
+            bb->AppendWithEndian((uint8_t)0xce, Big);
+            bb->AppendWithEndian((uint32_t)value, Big);
+        } else {
+            bb->AppendWithEndian((uint8_t)0xcf, Big);
+            bb->AppendWithEndian((uint64_t)value, Big);
+        }
+    } else if (value >= INT8_MIN) {
+        bb->AppendWithEndian((uint8_t)0xd0, Big);
+        bb->AppendWithEndian((int8_t)value, Big);
+    } else if (value >= INT16_MIN) {
+        bb->AppendWithEndian((uint8_t)0xd1, Big);
+        bb->AppendWithEndian((int16_t)value, Big);
+    } else if (value >= INT32_MIN) {
+        bb->AppendWithEndian((uint8_t)0xd2, Big);
+        bb->AppendWithEndian((int32_t)value, Big);
+    } else {
+        bb->AppendWithEndian((uint8_t)0xd3, Big);
+        bb->AppendWithEndian(value, Big);
+    }
+}
+
+void append_MessagePack_float(ByteBuffer* bb, double value) {
+    bb->AppendWithEndian((uint8_t)0xcb, Big);
+    bb->AppendWithEndian(value, Big);
+}
+
+void append_MessagePack_string(ByteBuffer* bb, std::string_view value) {
+    auto size = value.size();
+    if (size < 32) {
+        bb->AppendWithEndian((uint8_t)(0xa0 | size), Big);
+    } else if (size <= UINT8_MAX) {
+        bb->AppendWithEndian((uint8_t)0xd9, Big);
+        bb->AppendWithEndian((uint8_t)size, Big);
+    } else if (size <= UINT16_MAX) {
+        bb->AppendWithEndian((uint8_t)0xda, Big);
+        bb->AppendWithEndian((uint16_t)size, Big);
+    } else {
+        bb->AppendWithEndian((uint8_t)0xdb, Big);
+        bb->AppendWithEndian((uint32_t)size, Big);
+    }
+    bb->Append((char*)value.data(), size);
+}
+
+void append_MessagePack_symbol(ByteBuffer* bb, std::string_view name) {
+    auto size = name.size();
+    switch (size) {
+        case 1:
+            bb->AppendWithEndian((uint8_t)0xd4, Big);
+            break;
+        case 2:
+            bb->AppendWithEndian((uint8_t)0xd5, Big);
+            break;
+        case 4:
+            bb->AppendWithEndian((uint8_t)0xd6, Big);
+            break;
+        case 8:
+            bb->AppendWithEndian((uint8_t)0xd7, Big);
+            break;
+        case 16:
+            bb->AppendWithEndian((uint8_t)0xd8, Big);
+            break;
+        default:
+            if (size <= UINT8_MAX) {
+                bb->AppendWithEndian((uint8_t)0xc7, Big);
+                bb->AppendWithEndian((uint8_t)size, Big);
+            } else if (size <= UINT16_MAX) {
+                bb->AppendWithEndian((uint8_t)0xc8, Big);
+                bb->AppendWithEndian((uint16_t)size, Big);
+            } else {
+                bb->AppendWithEndian((uint8_t)0xc9, Big);
+                bb->AppendWithEndian((uint32_t)size, Big);
+            }
+    }
+    bb->AppendWithEndian(MSGPACK_SYMBOL_EXT, Big);
+    bb->Append((char*)name.data(), size);
+}
+
+void append_MessagePack_array(ByteBuffer* bb, uint32_t size) {
+    if (size < 16) {
+        bb->AppendWithEndian((uint8_t)(0x90 | size), Big);
+    } else if (size <= UINT16_MAX) {
+        bb->AppendWithEndian((uint8_t)0xdc, Big);
+        bb->AppendWithEndian((uint16_t)size, Big);
+    } else {
+        bb->AppendWithEndian((uint8_t)0xdd, Big);
+        bb->AppendWithEndian(size, Big);
+    }
+}
+
+void append_MessagePack_map(ByteBuffer* bb, uint32_t size) {
+    if (size < 16) {
+        bb->AppendWithEndian((uint8_t)(0x80 | size), Big);
+    } else if (size <= UINT16_MAX) {
+        bb->AppendWithEndian((uint8_t)0xde, Big);
+        bb->AppendWithEndian((uint16_t)size, Big);
+    } else {
+        bb->AppendWithEndian((uint8_t)0xdf, Big);
+        bb->AppendWithEndian(size, Big);
+    }
+}
+
+MessagePackReader::MessagePackReader(const uint8_t* data, size_t size) :
+    m_sr(data, size), m_frames(), m_depth(0), m_done(false) {}
+
+MessagePackReader::MessagePackReader(ReadBuffer* rb) : m_sr(rb), m_frames(), m_depth(0), m_done(false) {}
+
+tl::expected<CursorValue, OSSPErrorInfo> MessagePackReader::Next() {
+    CursorValue value = {};
+    if (m_depth > 0) {
+        auto& frame = m_frames[m_depth - 1];
+        if (frame.remaining == 0) {
+            m_depth--;
+            value.event = CursorEvent::End;
+            return value;
+        }
+        value.key = frame.map && frame.remaining % 2 == 0;
+        frame.remaining--;
+    } else if (m_done) {
+        // the top level holds exactly one value
+        value.event = CursorEvent::End;
+        return value;
+    } else {
+        m_done = true;
+    }
+    return ReadValue(value);
+}
+
+uint16_t MessagePackReader::Depth() const {
+    return m_depth;
+}
+
+size_t MessagePackReader::Position() const {
+    return m_sr.CurrentReadingPos();
+}
+
+tl::expected<CursorValue, OSSPErrorInfo> MessagePackReader::ReadValue(CursorValue value) {
+    auto position = m_sr.CurrentReadingPos();
+    uint8_t tag;
+    if (!m_sr.ReadWithEndian(&tag, Big)) {
+        return make_OSSP_error(OSSPInvalidMessagePackError, position);
+    }
+
+    if (tag <= 0x7f || tag >= 0xe0) {
+        value.event = CursorEvent::Int;
+        value.integer = (int8_t)tag;
+        if (tag <= 0x7f) {
+            value.integer = tag;
+        }
+        return value;
+    }
+    if (tag <= 0x8f) {
+        return BeginContainer(value, true, tag & 0x0f);
+    }
+    if (tag <= 0x9f) {
+        return BeginContainer(value, false, tag & 0x0f);
+    }
+
+    uint32_t length = tag & 0x1f;
+    switch (tag) {
+        case 0xc0:
+            value.event = CursorEvent::Nil;
+            return value;
+        case 0xc2:
+        case 0xc3:
+            value.event = CursorEvent::Bool;
+            value.boolean = tag == 0xc3;
+            return value;
+        case 0xc4:
+        case 0xc5:
+        case 0xc6:
+            // bin, mRuby Strings hold bytes anyway
+            if (!ReadLength((uint8_t)(1 << (tag - 0xc4)), &length)) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+            break;
+        case 0xc7:
+        case 0xc8:
+        case 0xc9:
+            if (!ReadLength((uint8_t)(1 << (tag - 0xc7)), &length)) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+            return ReadExt(value, length);
+        case 0xca: {
+            float number;
+            if (!m_sr.ReadWithEndian(&number, Big)) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+            value.event = CursorEvent::Float;
+            value.number = number;
+            return value;
+        }
+        case 0xcb:
+            value.event = CursorEvent::Float;
+            if (!m_sr.ReadWithEndian(&value.number, Big)) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+            return value;
+        case 0xcc:
+        case 0xcd:
+        case 0xce:
+        case 0xcf: {
+            uint64_t number = 0;
+            bool read;
+            if (tag == 0xcc) {
+                uint8_t small;
+                read = m_sr.ReadWithEndian(&small, Big);
+                number = small;
+            } else if (tag == 0xcd) {
+                uint16_t small;
+                read = m_sr.ReadWithEndian(&small, Big);
+                number = small;
+            } else if (tag == 0xce) {
+                uint32_t small;
+                read = m_sr.ReadWithEndian(&small, Big);
+                number = small;
+            } else {
+                read = m_sr.ReadWithEndian(&number, Big);
+            }
+            if (!read) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+            if (number > INT64_MAX) {
+                value.event = CursorEvent::Float;
+                value.number = (double)number;
+            } else {
+                value.event = CursorEvent::Int;
+                value.integer = (int64_t)number;
+            }
+            return value;
+        }
+        case 0xd0:
+        case 0xd1:
+        case 0xd2:
+        case 0xd3: {
+            bool read;
+            if (tag == 0xd0) {
+                int8_t small;
+                read = m_sr.ReadWithEndian(&small, Big);
+                value.integer = small;
+            } else if (tag == 0xd1) {
+                int16_t small;
+                read = m_sr.ReadWithEndian(&small, Big);
+                value.integer = small;
+            } else if (tag == 0xd2) {
+                int32_t small;
+                read = m_sr.ReadWithEndian(&small, Big);
+                value.integer = small;
+            } else {
+                read = m_sr.ReadWithEndian(&value.integer, Big);
+            }
+            if (!read) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+            value.event = CursorEvent::Int;
+            return value;
+        }
+        case 0xd4:
+        case 0xd5:
+        case 0xd6:
+        case 0xd7:
+        case 0xd8:
+            // fixext 1, 2, 4, 8 and 16
+            return ReadExt(value, 1u << (tag - 0xd4));
+        case 0xd9:
+        case 0xda:
+        case 0xdb:
+            if (!ReadLength((uint8_t)(1 << (tag - 0xd9)), &length)) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+            break;
+        case 0xdc:
+        case 0xdd:
+        case 0xde:
+        case 0xdf: {
+            bool map = tag >= 0xde;
+            if (!ReadLength(tag == 0xdc || tag == 0xde ? 2 : 4, &length)) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+            return BeginContainer(value, map, length);
+        }
+        default:
+            // fixstr, 0xc1 is never used
+            if (tag > 0xbf) {
+                return make_OSSP_error(OSSPInvalidMessagePackError, position);
+            }
+    }
+
+    // str and bin
+    value.event = CursorEvent::String;
+    if (!ReadBytes(length, &value.string)) {
+        return make_OSSP_error(OSSPInvalidMessagePackError, position);
+    }
+    return value;
+}
+
+bool MessagePackReader::ReadLength(uint8_t size, uint32_t* length) {
+    if (size == 1) {
+        uint8_t small;
+        auto read = m_sr.ReadWithEndian(&small, Big);
+        *length = small;
+        return read;
+    }
+    if (size == 2) {
+        uint16_t small;
+        auto read = m_sr.ReadWithEndian(&small, Big);
+        *length = small;
+        return read;
+    }
+    return m_sr.ReadWithEndian(length, Big);
+}
+
+bool MessagePackReader::ReadBytes(uint32_t length, std::string_view* bytes) {
+    if (m_sr.Remaining() < length) {
+        return false;
+    }
+    *bytes = std::string_view((const char*)m_sr.Current(), length);
+    m_sr.Skip(length);
+    return true;
+}
+
+tl::expected<CursorValue, OSSPErrorInfo> MessagePackReader::BeginContainer(CursorValue value, bool map, uint32_t size) {
+    if (m_depth >= max_depth) {
+        return make_OSSP_error(OSSPMaxDepthError, m_sr.CurrentReadingPos());
+    }
+    // every key and value needs at least one byte
+    uint64_t remaining = map ? (uint64_t)size * 2 : size;
+    if (m_sr.Remaining() < remaining) {
+        return make_OSSP_error(OSSPInvalidMessagePackError, m_sr.CurrentReadingPos());
+    }
+    m_frames[m_depth++] = {remaining, map};
+    value.event = map ? CursorEvent::BeginHash : CursorEvent::BeginArray;
+    value.size = size;
+    return value;
+}
+
+tl::expected<CursorValue, OSSPErrorInfo> MessagePackReader::ReadExt(CursorValue value, uint32_t length) {
+    auto position = m_sr.CurrentReadingPos();
+    int8_t type;
+    if (!m_sr.ReadWithEndian(&type, Big) || !ReadBytes(length, &value.string)) {
+        return make_OSSP_error(OSSPInvalidMessagePackError, position);
+    }
+    if (type != MSGPACK_SYMBOL_EXT) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, position);
+    }
+    value.event = CursorEvent::Symbol;
+    return value;
+}
+
+void MessagePack::Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options) {
+    SerializeRecursive(bb, mrb, data, options);
+}
+
+tl::expected<mrb_value, OSSPErrorInfo> MessagePack::Deserialize(ReadBuffer* rb, mrb_state* mrb,
+                                                                const DecodeOptions& options) {
+    MessagePackReader reader(rb);
+    auto value = reader.Next();
+    if (!value) {
+        return tl::unexpected(value.error());
+    }
+    auto decoded = DecodeValue(&reader, value.value(), mrb, options);
+    if (!decoded) {
+        return decoded;
+    }
+    if (reader.Position() != rb->Size()) {
+        return make_OSSP_error(OSSPInvalidMessagePackError, reader.Position());
+    }
+    return decoded;
+}
+
+void MessagePack::SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options) {
+    if (options.records != nullptr) {
+        auto record = options.records->Find(data);
+        if (record != nullptr) {
+            append_MessagePack_map(bb, (uint32_t)record->keys.size());
+            for (size_t i = 0; i < record->keys.size(); i++) {
+                SerializeRecursive(bb, mrb, mrb_symbol_value(record->keys[i]), options);
+                SerializeRecursive(bb, mrb, mrb_iv_get(mrb, data, record->ivars[i]), options);
+            }
+            return;
+        }
+    }
+    if (get_OSSP_tracked(data) != nullptr) {
+        SerializeRecursive(bb, mrb, get_OSSP_tracked_data(mrb, data), options);
+        return;
+    }
+    auto typed_array = get_OSSP_typed_array(data);
+    if (typed_array != nullptr) {
+        append_MessagePack_array(bb, (uint32_t)typed_array->size);
+        for (size_t i = 0; i < typed_array->size; i++) {
+            if (typed_array->type == TypedArrayType::Float64) {
+                append_MessagePack_float(bb, ((const double*)typed_array->data)[i]);
+            } else {
+                append_MessagePack_int(bb, ((const int64_t*)typed_array->data)[i]);
+            }
+        }
+        return;
+    }
+
+    switch (OSSP::GetType(data)) {
+        case ST_FALSE:
+            append_MessagePack_bool(bb, false);
+            return;
+        case ST_TRUE:
+            append_MessagePack_bool(bb, true);
+            return;
+        case ST_INT:
+            append_MessagePack_int(bb, cext_to_int(mrb, data));
+            return;
+        case ST_FLOAT:
+            append_MessagePack_float(bb, cext_to_float(mrb, data));
+            return;
+        case ST_STRING:
+            append_MessagePack_string(bb, std::string_view(RSTRING_PTR(data), RSTRING_LEN(data)));
+            return;
+        case ST_SYMBOL: {
+            mrb_int len;
+            auto name = mrb_sym_name_len(mrb, mrb_symbol(data), &len);
+            append_MessagePack_symbol(bb, std::string_view(name, len));
+            return;
+        }
+        case ST_ARRAY: {
+            mrb_int array_size = RARRAY_LEN(data);
+            append_MessagePack_array(bb, (uint32_t)array_size);
+            for (mrb_int i = 0; i < array_size; i++) {
+                SerializeRecursive(bb, mrb, RARRAY_PTR(data)[i], options);
+            }
+            return;
+        }
+        case ST_HASH: {
+            append_MessagePack_map(bb, (uint32_t)mrb_hash_size(mrb, data));
+            typedef struct to_pass_t {
+                ByteBuffer* buffer;
+                const EncodeOptions* options;
+            } to_pass_t;
+            to_pass_t to_pass = {bb, &options};
+
+            // MessagePack takes keys of any type, so every entry is written and the size stays right
+            mrb_hash_foreach(mrb, mrb_hash_ptr(data), {[](mrb_state* intern_state, mrb_value key, mrb_value val, void* passed) -> int {
+                auto to_pass = (to_pass_t*)passed;
+                SerializeRecursive(to_pass->buffer, intern_state, key, *to_pass->options);
+                SerializeRecursive(to_pass->buffer, intern_state, val, *to_pass->options);
+                return 0;
+            }}, &to_pass);
+            return;
+        }
+        default:
+            append_MessagePack_nil(bb);
+            return;
+    }
+}
+
+tl::expected<mrb_value, OSSPErrorInfo> MessagePack::DecodeValue(MessagePackReader* reader, const CursorValue& value,
+                                                                mrb_state* mrb, const DecodeOptions& options) {
+    switch (value.event) {
+        case CursorEvent::Nil:
+            return mrb_nil_value();
+        case CursorEvent::Bool:
+            return mrb_bool_value(value.boolean);
+        case CursorEvent::Int:
+            return mrb_int_value(mrb, (mrb_int)value.integer);
+        case CursorEvent::Float:
+            return mrb_float_value(mrb, value.number);
+        case CursorEvent::String:
+            if (value.key && options.keys == KeyConversion::Symbolize) {
+                return mrb_symbol_value(mrb_intern(mrb, value.string.data(), value.string.size()));
+            }
+            return DecodeString(value.string, mrb, options);
+        case CursorEvent::Symbol:
+            if (value.key && options.keys == KeyConversion::Stringify) {
+                return DecodeString(value.string, mrb, options);
+            }
+            return mrb_symbol_value(mrb_intern(mrb, value.string.data(), value.string.size()));
+        case CursorEvent::BeginHash:
+            return DecodeMap(reader, value, mrb, options);
+        case CursorEvent::BeginArray: {
+            mrb_value array = mrb_ary_new_capa(mrb, (mrb_int)value.size);
+            for (mrb_int i = 0; i < (mrb_int)value.size; i++) {
+                auto next = reader->Next();
+                if (!next) {
+                    return tl::unexpected(next.error());
+                }
+                auto element = DecodeValue(reader, next.value(), mrb, options);
+                if (!element) {
+                    return element;
+                }
+                mrb_ary_set(mrb, array, i, element.value());
+            }
+            // the End of the array, which can not fail
+            auto end = reader->Next();
+            if (!end) {
+                return tl::unexpected(end.error());
+            }
+            return array;
+        }
+        default:
+            return make_OSSP_error(OSSPInvalidMessagePackError, reader->Position());
+    }
+}
+
+tl::expected<mrb_value, OSSPErrorInfo> MessagePack::DecodeMap(MessagePackReader* reader, const CursorValue& value,
+                                                              mrb_state* mrb, const DecodeOptions& options) {
+    // with records the entries are collected first, as in BasicOSSP::DecodeRecord
+    std::vector<mrb_value> entries;
+    mrb_value hash = mrb_hash_new(mrb);
+    for (uint64_t i = 0; i < (uint64_t)value.size * 2; i++) {
+        auto next = reader->Next();
+        if (!next) {
+            return tl::unexpected(next.error());
+        }
+        auto decoded = DecodeValue(reader, next.value(), mrb, options);
+        if (!decoded) {
+            return decoded;
+        }
+        entries.push_back(decoded.value());
+        if (options.records == nullptr && i % 2 == 1) {
+            mrb_hash_set(mrb, hash, entries[0], entries[1]);
+            entries.clear();
+        }
+    }
+    // the End of the map, which can not fail
+    auto end = reader->Next();
+    if (!end) {
+        return tl::unexpected(end.error());
+    }
+
+    if (options.records == nullptr) {
+        return hash;
+    }
+    auto size = entries.size() / 2;
+    if (options.records->MayMatch(size)) {
+        auto record = options.records->Materialize(mrb, entries.data(), size);
+        if (!mrb_nil_p(record)) {
+            return record;
+        }
+    }
+    for (size_t i = 0; i < size; i++) {
+        mrb_hash_set(mrb, hash, entries[i * 2], entries[i * 2 + 1]);
+    }
+    return hash;
+}
+
+mrb_value MessagePack::DecodeString(std::string_view string, mrb_state* mrb, const DecodeOptions& options) {
+    if (options.strings != nullptr) {
+        return options.strings->Get(mrb, string.data(), string.size());
+    }
+    return mrb_str_new(mrb, string.data(), string.size());
+}
+
+}
@@ -2,19 +2,29 @@
 
 #include "ossp/help.h"
 #include "ossp/serialize.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
 
 namespace lyniat::ossp::serialize::bin {
 
-void OSSP::Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const std::string& meta_data) {
-    bb->AppendWithEndian(LE_MAGIC_NUMBER, endian);
-    bb->AppendWithEndian(EOD_POSITION, endian);
-    bb->AppendWithEndian(FLAGS, endian);
-    SerializeRecursive(bb, mrb, data);
+template <typename Options>
+template <typename F>
+void BasicOSSP<Options>::SerializeMessage(ByteBuffer* bb, const std::string& meta_data, F&& write_data) {
+    bb->AppendWithEndian(LE_MAGIC_NUMBER, header_endian);
+    bb->AppendWithEndian(EOD_POSITION, header_endian);
+    bb->AppendWithEndian(Options::features, header_endian);
+    auto data_pos = bb->Size();
+    write_data();
+    if constexpr (Options::checksum) {
+        auto checksum = Checksum((const uint8_t*)bb->DataAt(data_pos), bb->Size() - data_pos);
+        bb->AppendWithEndian(checksum, header_endian);
+    }
     auto data_size = bb->Size();
     if (data_size > UINT32_MAX) {
         // TODO: handle this problem just in case it should ever happen
     }
-    bb->SetAtWithEndian(sizeof(LE_MAGIC_NUMBER), (uint32_t)data_size, endian);
+    bb->SetAtWithEndian(sizeof(LE_MAGIC_NUMBER), (uint32_t)data_size, header_endian);
 
     if (!meta_data.empty()) {
         bb->Append(END_OF_DATA, strlen(END_OF_DATA));
@@ -25,71 +35,383 @@ void OSSP::Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const std::
     }
 }
 
-tl::expected<mrb_value, OSSPErrorInfo> OSSP::Deserialize(ReadBuffer* bb, mrb_state* mrb) {
-    uint32_t magic_number;
-    uint32_t eod_position;
-    uint64_t flags;
-    if (!bb->ReadWithEndian(&magic_number, endian)) {
-        auto error = OSSPReadingError;
-        error.position = bb->CurrentReadingPos();
-        return tl::unexpected(error);
+template <typename Options>
+void BasicOSSP<Options>::Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const std::string& meta_data,
+                                   const EncodeOptions& options) {
+    SerializeMessage(bb, meta_data, [&]() {
+        SerializeRecursive(bb, mrb, data, options);
+    });
+}
+
+template <typename Options>
+void BasicOSSP<Options>::EncodeChanges(ByteBuffer* bb, mrb_state* mrb, mrb_value tracked, const std::string& meta_data,
+                                       const EncodeOptions& options) {
+    ByteBuffer operations;
+    std::vector<mrb_value> path;
+    // anything that is not tracked can only be sent as a whole
+    size_t count = UINT16_MAX + 1;
+    if (get_OSSP_tracked(tracked) != nullptr) {
+        count = SerializeChanges(&operations, mrb, tracked, &path, options);
     }
+    SerializePatch(bb, mrb, operations, count, tracked, meta_data, options);
+    clear_OSSP_tracked(mrb, tracked);
+}
 
-    if (magic_number != LE_MAGIC_NUMBER) {
-        auto error = OSSPMagicNumberError;
-        error.position = bb->CurrentReadingPos();
-        return tl::unexpected(error);
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicOSSP<Options>::EncodeDelta(ByteBuffer* bb, ReadBuffer* baseline, mrb_state* mrb,
+                                                                  mrb_value current, const std::string& meta_data,
+                                                                  const EncodeOptions& options) {
+    SpanReader sr(baseline);
+    auto header = ReadHeader(&sr);
+    if (!header) {
+        return tl::unexpected(header.error());
+    }
+    if (header->flags != Options::features) {
+        return dispatch_OSSP_features(header->flags, [&](auto features) {
+            return BasicOSSP<decltype(features)>::EncodeDelta(bb, baseline, mrb, current, meta_data, options);
+        });
+    }
+    auto data_sr = DataReader(sr, header.value<>());
+    if (!data_sr) {
+        return tl::unexpected(data_sr.error());
     }
 
-    if (!bb->ReadWithEndian(&eod_position, endian)) {
-        auto error = OSSPReadingError;
-        error.position = bb->CurrentReadingPos();
-        return tl::unexpected(error);
+    ByteBuffer operations;
+    std::vector<mrb_value> path;
+    auto count = SerializeDelta(&operations, &data_sr.value<>(), mrb, current, &path, options, 0);
+    if (!count) {
+        return tl::unexpected(count.error());
     }
+    SerializePatch(bb, mrb, operations, count.value<>(), current, meta_data, options);
+    return {};
+}
 
-    if (!bb->ReadWithEndian(&flags, endian)) {
-        auto error = OSSPReadingError;
-        error.position = bb->CurrentReadingPos();
-        return tl::unexpected(error);
+template <typename Options>
+void BasicOSSP<Options>::SerializePatch(ByteBuffer* bb, mrb_state* mrb, const ByteBuffer& operations, size_t count,
+                                        mrb_value value, const std::string& meta_data, const EncodeOptions& options) {
+    SerializeMessage(bb, meta_data, [&]() {
+        bb->AppendWithEndian((uint8_t)ST_ARRAY, endian);
+        if (count <= UINT16_MAX) {
+            bb->AppendWithEndian((st_counter_t)count, endian);
+            if (operations.Size() > 0) {
+                bb->Append((char*)operations.DataAt(0), operations.Size());
+            }
+            return;
+        }
+        // this many changes are not worth it anyway
+        std::vector<mrb_value> root;
+        bb->AppendWithEndian((st_counter_t)1, endian);
+        SerializeOperation(bb, mrb, PatchOp::Set, root, &value, options);
+    });
+}
+
+template <typename Options>
+size_t BasicOSSP<Options>::SerializeChanges(ByteBuffer* bb, mrb_state* mrb, mrb_value tracked,
+                                            std::vector<mrb_value>* path, const EncodeOptions& options) {
+    auto container = get_OSSP_tracked(tracked);
+    auto data = get_OSSP_tracked_data(mrb, tracked);
+    auto size = container->hash ? 0 : (size_t)RARRAY_LEN(data);
+    size_t count = 0;
+    // resizing comes first, so the following operations can address new elements
+    if (!container->hash && size != container->synced_size) {
+        auto new_size = mrb_int_value(mrb, (mrb_int)size);
+        SerializeOperation(bb, mrb, PatchOp::Resize, *path, &new_size, options);
+        count++;
     }
+    for_each_OSSP_slot(container->dirty, [&](size_t slot) {
+        if (container->hash) {
+            auto key = get_OSSP_tracked_key(mrb, tracked, slot);
+            path->push_back(key);
+            if (mrb_hash_key_p(mrb, data, key)) {
+                auto value = mrb_hash_get(mrb, data, key);
+                SerializeOperation(bb, mrb, PatchOp::Set, *path, &value, options);
+            } else {
+                SerializeOperation(bb, mrb, PatchOp::Delete, *path, nullptr, options);
+            }
+        } else if (slot < size) {
+            path->push_back(mrb_int_value(mrb, (mrb_int)slot));
+            SerializeOperation(bb, mrb, PatchOp::Set, *path, &RARRAY_PTR(data)[slot], options);
+        } else {
+            // written and removed again
+            return;
+        }
+        path->pop_back();
+        count++;
+    });
+    for_each_OSSP_slot(container->children, [&](size_t slot) {
+        // already written as a whole
+        if (test_OSSP_slot(container->dirty, slot)) {
+            return;
+        }
+        auto key = container->hash ? get_OSSP_tracked_key(mrb, tracked, slot) : mrb_int_value(mrb, (mrb_int)slot);
+        auto value = mrb_nil_value();
+        if (container->hash) {
+            value = mrb_hash_get(mrb, data, key);
+        } else if (slot < size) {
+            value = RARRAY_PTR(data)[slot];
+        }
+        if (get_OSSP_tracked(value) == nullptr) {
+            return;
+        }
+        path->push_back(key);
+        count += SerializeChanges(bb, mrb, value, path, options);
+        path->pop_back();
+    });
+    return count;
+}
 
-    auto bb_size = bb->Size();
-    auto eof_len = strlen(END_OF_FILE);
-    if (bb_size < eof_len) {
-        auto error = OSSPWrongBufferSizeError;
-        error.position = bb->CurrentReadingPos();
-        return tl::unexpected(error);
+template <typename Options>
+void BasicOSSP<Options>::SerializeOperation(ByteBuffer* bb, mrb_state* mrb, PatchOp op,
+                                            const std::vector<mrb_value>& path, const mrb_value* value,
+                                            const EncodeOptions& options) {
+    bb->AppendWithEndian((uint8_t)ST_ARRAY, endian);
+    bb->AppendWithEndian((st_counter_t)(value != nullptr ? 3 : 2), endian);
+    SerializeRecursive(bb, mrb, mrb_int_value(mrb, (mrb_int)op), options);
+    bb->AppendWithEndian((uint8_t)ST_ARRAY, endian);
+    bb->AppendWithEndian((st_counter_t)path.size(), endian);
+    for (auto& element : path) {
+        SerializeRecursive(bb, mrb, element, options);
+    }
+    if (value != nullptr) {
+        SerializeRecursive(bb, mrb, *value, options);
     }
+}
 
-    std::string first_end_content;
-    bb->ReadStringAt(eod_position, &first_end_content, strlen(END_OF_DATA));
-    bool has_meta_data = false;
-    if (first_end_content == std::string(END_OF_DATA)) {
-        has_meta_data = true;
-    } else if (first_end_content != std::string(END_OF_FILE)) {
-        auto error = OSSPEOFError;
-        error.position = eod_position;
-        return tl::unexpected(error);
+template <typename Options>
+tl::expected<size_t, OSSPErrorInfo> BasicOSSP<Options>::SerializeDelta(ByteBuffer* bb, SpanReader* sr, mrb_state* mrb,
+                                                                       mrb_value current, std::vector<mrb_value>* path,
+                                                                       const EncodeOptions& options, uint16_t depth) {
+    if (depth >= max_depth) {
+        return make_OSSP_error(OSSPMaxDepthError, sr->CurrentReadingPos());
+    }
+    if (sr->Remaining() == 0) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    if (get_OSSP_tracked(current) != nullptr) {
+        current = get_OSSP_tracked_data(mrb, current);
+    }
+    auto base_type = *sr->Current();
+    auto type = GetType(current);
+
+    if (base_type == ST_HASH && type == ST_HASH &&
+        (options.tables == nullptr || options.tables->Find(mrb, current) == nullptr)) {
+        return SerializeHashDelta(bb, sr, mrb, current, path, options, depth);
+    }
+    if (base_type == ST_ARRAY && type == ST_ARRAY) {
+        return SerializeArrayDelta(bb, sr, mrb, current, path, options, depth);
+    }
+
+    auto base_int = base_type == ST_INT || (base_type >= ST_ADV_BYTE_1 && base_type <= ST_ADV_BYTE_8);
+    if ((type == ST_INT && base_int) || (type == ST_FLOAT && base_type == ST_FLOAT)) {
+        auto base = DeserializeRecursive(sr, mrb, {}, depth);
+        if (!base) {
+            return tl::unexpected(base.error());
+        }
+        uint64_t bits;
+        if (type == ST_INT) {
+            bits = (uint64_t)cext_to_int(mrb, base.value<>()) ^ (uint64_t)cext_to_int(mrb, current);
+        } else {
+            uint64_t base_bits;
+            uint64_t current_bits;
+            mrb_float base_number = cext_to_float(mrb, base.value<>());
+            mrb_float current_number = cext_to_float(mrb, current);
+            memcpy(&base_bits, &base_number, sizeof(base_bits));
+            memcpy(&current_bits, &current_number, sizeof(current_bits));
+            bits = base_bits ^ current_bits;
+        }
+        if (bits == 0) {
+            return 0;
+        }
+        auto xor_bits = mrb_int_value(mrb, (mrb_int)bits);
+        SerializeOperation(bb, mrb, type == ST_INT ? PatchOp::XorInt : PatchOp::XorFloat, *path, &xor_bits, options);
+        return 1;
+    }
+
+    auto matches = MatchValue(sr, mrb, current, options);
+    if (!matches) {
+        return tl::unexpected(matches.error());
+    }
+    if (matches.value<>()) {
+        return 0;
+    }
+    SerializeOperation(bb, mrb, PatchOp::Set, *path, &current, options);
+    return 1;
+}
+
+template <typename Options>
+tl::expected<size_t, OSSPErrorInfo> BasicOSSP<Options>::SerializeHashDelta(ByteBuffer* bb, SpanReader* sr, mrb_state* mrb,
+                                                                           mrb_value current, std::vector<mrb_value>* path,
+                                                                           const EncodeOptions& options, uint16_t depth) {
+    st_counter_t hash_size;
+    sr->Skip(1);
+    if (!sr->ReadWithEndian(&hash_size, endian)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    auto entries = *sr;
+    size_t count = 0;
+    mrb_int matched = 0;
+    for (st_counter_t i = 0; i < hash_size; i++) {
+        auto key = DecodeHashKey(sr, mrb, {}, depth);
+        if (!key) {
+            return tl::unexpected(key.error());
+        }
+        path->push_back(key.value<>());
+        if (!mrb_hash_key_p(mrb, current, key.value<>())) {
+            SerializeOperation(bb, mrb, PatchOp::Delete, *path, nullptr, options);
+            path->pop_back();
+            count++;
+            auto skipped = SkipValue(sr, depth + 1);
+            if (!skipped) {
+                return tl::unexpected(skipped.error());
+            }
+            continue;
+        }
+        matched++;
+        auto changes = SerializeDelta(bb, sr, mrb, mrb_hash_get(mrb, current, key.value<>()), path, options, depth + 1);
+        path->pop_back();
+        if (!changes) {
+            return changes;
+        }
+        count += changes.value<>();
+    }
+
+    if (matched == mrb_hash_size(mrb, current)) {
+        return count;
+    }
+    // some keys are new, the baseline keys are read once more to find them
+    auto known = mrb_hash_new_capa(mrb, hash_size);
+    for (st_counter_t i = 0; i < hash_size; i++) {
+        auto key = DecodeHashKey(&entries, mrb, {}, depth);
+        if (!key) {
+            return tl::unexpected(key.error());
+        }
+        mrb_hash_set(mrb, known, key.value<>(), mrb_true_value());
+        auto skipped = SkipValue(&entries, depth + 1);
+        if (!skipped) {
+            return tl::unexpected(skipped.error());
+        }
+    }
+    auto keys = mrb_hash_keys(mrb, current);
+    for (mrb_int i = 0; i < RARRAY_LEN(keys); i++) {
+        auto key = RARRAY_PTR(keys)[i];
+        if (mrb_hash_key_p(mrb, known, key)) {
+            continue;
+        }
+        auto value = mrb_hash_get(mrb, current, key);
+        path->push_back(key);
+        SerializeOperation(bb, mrb, PatchOp::Set, *path, &value, options);
+        path->pop_back();
+        count++;
+    }
+    return count;
+}
+
+template <typename Options>
+tl::expected<size_t, OSSPErrorInfo> BasicOSSP<Options>::SerializeArrayDelta(ByteBuffer* bb, SpanReader* sr, mrb_state* mrb,
+                                                                            mrb_value current, std::vector<mrb_value>* path,
+                                                                            const EncodeOptions& options, uint16_t depth) {
+    st_counter_t array_size;
+    sr->Skip(1);
+    if (!sr->ReadWithEndian(&array_size, endian)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    size_t count = 0;
+    mrb_int size = RARRAY_LEN(current);
+    // resizing comes first, so the following operations can address new elements
+    if (size != array_size) {
+        auto new_size = mrb_int_value(mrb, size);
+        SerializeOperation(bb, mrb, PatchOp::Resize, *path, &new_size, options);
+        count++;
+    }
+    for (mrb_int i = 0; i < array_size; i++) {
+        if (i >= size) {
+            auto skipped = SkipValue(sr, depth + 1);
+            if (!skipped) {
+                return tl::unexpected(skipped.error());
+            }
+            continue;
+        }
+        path->push_back(mrb_int_value(mrb, i));
+        auto changes = SerializeDelta(bb, sr, mrb, RARRAY_PTR(current)[i], path, options, depth + 1);
+        path->pop_back();
+        if (!changes) {
+            return changes;
+        }
+        count += changes.value<>();
+    }
+    for (mrb_int i = array_size; i < size; i++) {
+        path->push_back(mrb_int_value(mrb, i));
+        SerializeOperation(bb, mrb, PatchOp::Set, *path, &RARRAY_PTR(current)[i], options);
+        path->pop_back();
+        count++;
+    }
+    return count;
+}
+
+template <typename Options>
+tl::expected<bool, OSSPErrorInfo> BasicOSSP<Options>::MatchValue(SpanReader* sr, mrb_state* mrb, mrb_value current,
+                                                                 const EncodeOptions& options) {
+    auto base_type = *sr->Current();
+    auto type = GetType(current);
+    if ((base_type == ST_NIL || base_type == ST_TRUE || base_type == ST_FALSE) && base_type == type) {
+        sr->Skip(1);
+        return true;
+    }
+    // compared in place, the common case needs no buffer
+    if ((base_type == ST_STRING || base_type == ST_SYMBOL) && (type == ST_STRING || type == ST_SYMBOL)) {
+        return MatchKey(sr, mrb, current);
+    }
+    auto start = sr->CurrentReadingPos();
+    auto skipped = SkipValue(sr);
+    if (!skipped) {
+        return tl::unexpected(skipped.error());
+    }
+    ByteBuffer encoded;
+    SerializeRecursive(&encoded, mrb, current, options);
+    auto size = sr->CurrentReadingPos() - start;
+    return encoded.Size() == size && memcmp(encoded.DataAt(0), sr->DataAt(start), size) == 0;
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::Deserialize(ReadBuffer* bb, mrb_state* mrb,
+                                                                       const DecodeOptions& options) {
+    return DeserializeSpan(SpanReader(bb), mrb, options);
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::Deserialize(mrb_value source, mrb_state* mrb,
+                                                                       const DecodeOptions& options) {
+    auto source_options = options;
+    source_options.source = source;
+    return DeserializeSpan(SpanReader((const uint8_t*)RSTRING_PTR(source), RSTRING_LEN(source)), mrb,
+                           source_options);
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DeserializeSpan(SpanReader sr, mrb_state* mrb,
+                                                                           const DecodeOptions& options) {
+    auto start_sr = sr;
+    auto header = ReadHeader(&sr);
+    if (!header) {
+        return tl::unexpected(header.error());
+    }
+    if (header->flags != Options::features) {
+        return dispatch_OSSP_features(header->flags, [&](auto features) {
+            return BasicOSSP<decltype(features)>::DeserializeSpan(start_sr, mrb, options);
+        });
     }
 
     mrb_value ossp_meta_data = mrb_nil_value();
-    if (has_meta_data) {
-        std::string bb_end;
-        auto read_bb_end_pos = bb_size - strlen(END_OF_FILE);
-        bb->ReadStringAt(read_bb_end_pos,&bb_end ,strlen(END_OF_FILE));
-        if (bb_end != std::string(END_OF_FILE)) {
-            auto error = OSSPEOFError;
-            error.position = read_bb_end_pos;
-            return tl::unexpected(error);
-        }
-        auto str_n = bb_size - eod_position - strlen(END_OF_DATA) - strlen(END_OF_FILE);
-        //auto meta_str = std::string((const char*)bb->DataAt(eod_position + strlen(END_OF_DATA)), str_n);
-        std::string meta_str;
-        bb->ReadStringAt((eod_position + strlen(END_OF_DATA)), &meta_str, str_n);
+    if (header->has_meta_data) {
+        auto meta_str = std::string((const char*)sr.DataAt(header->meta_data_position), header->meta_data_size);
         ossp_meta_data = mrb_str_new_cstr(mrb, meta_str.c_str());
     }
 
-    auto deserialized = DeserializeRecursive(bb, mrb);
+    auto data_sr = DataReader(sr, header.value<>());
+    if (!data_sr) {
+        return tl::unexpected(data_sr.error());
+    }
+    auto deserialized = DeserializeRecursive(&data_sr.value<>(), mrb, options);
     if (deserialized) {
         mrb_value array = mrb_ary_new_capa(mrb, 2);
         mrb_ary_set(mrb, array, 0, deserialized.value<>());
@@ -99,19 +421,659 @@ tl::expected<mrb_value, OSSPErrorInfo> OSSP::Deserialize(ReadBuffer* bb, mrb_sta
     return deserialized;
 }
 
-void OSSP::SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data) {
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::Extract(ReadBuffer* rb, mrb_state* mrb, mrb_value path,
+                                                                   const DecodeOptions& options) {
+    SpanReader sr(rb);
+    auto header = ReadHeader(&sr);
+    if (!header) {
+        return tl::unexpected(header.error());
+    }
+    if (header->flags != Options::features) {
+        return dispatch_OSSP_features(header->flags, [&](auto features) {
+            return BasicOSSP<decltype(features)>::Extract(rb, mrb, path, options);
+        });
+    }
+    auto data_sr = DataReader(sr, header.value<>());
+    if (!data_sr) {
+        return tl::unexpected(data_sr.error());
+    }
+    sr = data_sr.value<>();
+
+    mrb_int path_size = RARRAY_LEN(path);
+    for (mrb_int i = 0; i < path_size; i++) {
+        auto found = SeekChild(&sr, mrb, RARRAY_PTR(path)[i]);
+        if (!found) {
+            return tl::unexpected(found.error());
+        }
+        if (!found.value<>()) {
+            return mrb_nil_value();
+        }
+    }
+    return DeserializeRecursive(&sr, mrb, options, path_size > max_depth ? max_depth : (uint16_t)path_size);
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::Project(ReadBuffer* rb, mrb_state* mrb, mrb_value keys,
+                                                                   const DecodeOptions& options) {
+    SpanReader sr(rb);
+    auto header = ReadHeader(&sr);
+    if (!header) {
+        return tl::unexpected(header.error());
+    }
+    if (header->flags != Options::features) {
+        return dispatch_OSSP_features(header->flags, [&](auto features) {
+            return BasicOSSP<decltype(features)>::Project(rb, mrb, keys, options);
+        });
+    }
+    auto data_sr = DataReader(sr, header.value<>());
+    if (!data_sr) {
+        return tl::unexpected(data_sr.error());
+    }
+    sr = data_sr.value<>();
+
+    uint8_t bin_type;
+    if (!sr.ReadWithEndian(&bin_type, endian)) {
+        return make_OSSP_error(OSSPReadingError, sr.CurrentReadingPos());
+    }
+    st_counter_t hash_size;
+    if (bin_type == ST_TABLE) {
+        auto table = ReadTable(&sr);
+        if (!table) {
+            return tl::unexpected(table.error());
+        }
+        hash_size = table->fields;
+    } else if (bin_type != ST_HASH) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, sr.CurrentReadingPos());
+    } else if (!sr.ReadWithEndian(&hash_size, endian)) {
+        return make_OSSP_error(OSSPReadingError, sr.CurrentReadingPos());
+    }
+
+    mrb_int keys_size = RARRAY_LEN(keys);
+    mrb_value hash = mrb_hash_new_capa(mrb, keys_size);
+    for (st_counter_t i = 0; i < hash_size; ++i) {
+        auto key_pos = sr.CurrentReadingPos();
+        mrb_int match = -1;
+        for (mrb_int k = 0; k < keys_size && match < 0; k++) {
+            sr.SetReadingPos(key_pos);
+            auto matches = MatchKey(&sr, mrb, RARRAY_PTR(keys)[k]);
+            if (!matches) {
+                return tl::unexpected(matches.error());
+            }
+            if (matches.value<>()) {
+                match = k;
+            }
+        }
+
+        if (match < 0) {
+            // nothing requested, so neither key nor value ever become mRuby objects
+            sr.SetReadingPos(key_pos);
+            auto skipped = SkipKey(&sr);
+            if (skipped) {
+                skipped = SkipValue(&sr);
+            }
+            if (!skipped) {
+                return tl::unexpected(skipped.error());
+            }
+            continue;
+        }
+
+        auto data = DeserializeRecursive(&sr, mrb, options, 1);
+        if (!data) {
+            return data;
+        }
+        mrb_hash_set(mrb, hash, RARRAY_PTR(keys)[match], data.value<>());
+    }
+    return hash;
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::ApplyPatch(ReadBuffer* patch, mrb_state* mrb, mrb_value target,
+                                                                      const DecodeOptions& options) {
+    SpanReader sr(patch);
+    auto header = ReadHeader(&sr);
+    if (!header) {
+        return tl::unexpected(header.error());
+    }
+    if (header->flags != Options::features) {
+        return dispatch_OSSP_features(header->flags, [&](auto features) {
+            return BasicOSSP<decltype(features)>::ApplyPatch(patch, mrb, target, options);
+        });
+    }
+    auto data_sr = DataReader(sr, header.value<>());
+    if (!data_sr) {
+        return tl::unexpected(data_sr.error());
+    }
+    sr = data_sr.value<>();
+
+    // a broken message is rejected before the first change
+    auto validate_sr = sr;
+    auto skipped = SkipValue(&validate_sr);
+    if (!skipped) {
+        return tl::unexpected(skipped.error());
+    }
+    if (validate_sr.Remaining() != 0) {
+        return make_OSSP_error(OSSPUnexpectedDataError, validate_sr.CurrentReadingPos());
+    }
+
+    uint8_t bin_type;
+    st_counter_t operations;
+    sr.ReadWithEndian(&bin_type, endian);
+    if (bin_type != ST_ARRAY || !sr.ReadWithEndian(&operations, endian)) {
+        return make_OSSP_error(OSSPInvalidPatchError, sr.CurrentReadingPos());
+    }
+    for (st_counter_t i = 0; i < operations; i++) {
+        auto applied = ApplyOperation(&sr, mrb, target, options);
+        if (!applied) {
+            return applied;
+        }
+        target = applied.value<>();
+    }
+    return target;
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::ApplyOperation(SpanReader* sr, mrb_state* mrb, mrb_value target,
+                                                                          const DecodeOptions& options) {
+    auto position = sr->CurrentReadingPos();
+    uint8_t bin_type;
+    st_counter_t operation_size;
+    if (!sr->ReadWithEndian(&bin_type, endian) || bin_type != ST_ARRAY ||
+        !sr->ReadWithEndian(&operation_size, endian) || operation_size < 2 || operation_size > 3) {
+        return make_OSSP_error(OSSPInvalidPatchError, position);
+    }
+    auto op = DeserializeRecursive(sr, mrb, {});
+    if (!op) {
+        return op;
+    }
+    if (GetType(op.value<>()) != ST_INT) {
+        return make_OSSP_error(OSSPInvalidPatchError, position);
+    }
+
+    st_counter_t path_size;
+    if (!sr->ReadWithEndian(&bin_type, endian) || bin_type != ST_ARRAY || !sr->ReadWithEndian(&path_size, endian)) {
+        return make_OSSP_error(OSSPInvalidPatchError, position);
+    }
+    auto container = mrb_nil_value();
+    auto step = mrb_nil_value();
+    auto node = target;
+    for (st_counter_t i = 0; i < path_size; i++) {
+        // keys are converted like those of the decoded target were
+        auto key = DecodeHashKey(sr, mrb, options);
+        if (!key) {
+            return key;
+        }
+        container = node;
+        step = key.value<>();
+        auto child = PatchChild(mrb, container, step, position);
+        if (!child) {
+            return child;
+        }
+        node = child.value<>();
+    }
+
+    auto value = mrb_nil_value();
+    if (operation_size == 3) {
+        auto decoded = DeserializeRecursive(sr, mrb, options);
+        if (!decoded) {
+            return decoded;
+        }
+        value = decoded.value<>();
+    }
+
+    switch ((PatchOp)cext_to_int(mrb, op.value<>())) {
+        case PatchOp::Set:
+            if (operation_size != 3) {
+                break;
+            }
+            return PatchReplace(mrb, target, container, step, value, position);
+        case PatchOp::Delete:
+            if (operation_size != 2 || !mrb_hash_p(container) || MRB_FROZEN_P(mrb_obj_ptr(container))) {
+                break;
+            }
+            mrb_hash_delete_key(mrb, container, step);
+            return target;
+        case PatchOp::Resize: {
+            if (operation_size != 3 || !mrb_array_p(node) || MRB_FROZEN_P(mrb_obj_ptr(node)) ||
+                GetType(value) != ST_INT) {
+                break;
+            }
+            auto size = cext_to_int(mrb, value);
+            if (size < 0 || size > UINT16_MAX) {
+                break;
+            }
+            mrb_ary_resize(mrb, node, size);
+            return target;
+        }
+        case PatchOp::XorInt:
+            if (operation_size != 3 || GetType(node) != ST_INT || GetType(value) != ST_INT) {
+                break;
+            }
+            return PatchReplace(mrb, target, container, step,
+                                mrb_int_value(mrb, cext_to_int(mrb, node) ^ cext_to_int(mrb, value)), position);
+        case PatchOp::XorFloat: {
+            if (operation_size != 3 || GetType(node) != ST_FLOAT || GetType(value) != ST_INT) {
+                break;
+            }
+            mrb_float number = cext_to_float(mrb, node);
+            uint64_t bits;
+            memcpy(&bits, &number, sizeof(bits));
+            bits ^= (uint64_t)cext_to_int(mrb, value);
+            memcpy(&number, &bits, sizeof(number));
+            return PatchReplace(mrb, target, container, step, mrb_float_value(mrb, number), position);
+        }
+    }
+    return make_OSSP_error(OSSPInvalidPatchError, position);
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::PatchChild(mrb_state* mrb, mrb_value container, mrb_value step,
+                                                                      size_t position) {
+    if (mrb_hash_p(container)) {
+        return mrb_hash_get(mrb, container, step);
+    }
+    if (!mrb_array_p(container) || GetType(step) != ST_INT) {
+        return make_OSSP_error(OSSPInvalidPatchError, position);
+    }
+    auto index = cext_to_int(mrb, step);
+    if (index < 0 || index >= RARRAY_LEN(container)) {
+        return mrb_nil_value();
+    }
+    return RARRAY_PTR(container)[index];
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::PatchReplace(mrb_state* mrb, mrb_value target, mrb_value container,
+                                                                        mrb_value step, mrb_value value, size_t position) {
+    if (mrb_nil_p(container)) {
+        return value;
+    }
+    if (MRB_FROZEN_P(mrb_obj_ptr(container))) {
+        return make_OSSP_error(OSSPInvalidPatchError, position);
+    }
+    if (mrb_hash_p(container)) {
+        mrb_hash_set(mrb, container, step, value);
+        return target;
+    }
+    // Arrays only grow through Resize
+    auto index = cext_to_int(mrb, step);
+    if (index < 0 || index >= RARRAY_LEN(container)) {
+        return make_OSSP_error(OSSPInvalidPatchError, position);
+    }
+    mrb_ary_set(mrb, container, index, value);
+    return target;
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::Diff(ReadBuffer* a, ReadBuffer* b, mrb_state* mrb,
+                                                                const DecodeOptions& options) {
+    SpanReader a_sr(a);
+    SpanReader b_sr(b);
+    auto a_header = ReadHeader(&a_sr);
+    if (!a_header) {
+        return tl::unexpected(a_header.error());
+    }
+    auto b_header = ReadHeader(&b_sr);
+    if (!b_header) {
+        return tl::unexpected(b_header.error());
+    }
+    // different encodings of the same value can not be compared byte by byte
+    if (a_header->flags != b_header->flags) {
+        return make_OSSP_error(OSSPUnsupportedFeaturesError, b_header->data_position);
+    }
+    if (a_header->flags != Options::features) {
+        return dispatch_OSSP_features(a_header->flags, [&](auto features) {
+            return BasicOSSP<decltype(features)>::Diff(a, b, mrb, options);
+        });
+    }
+    auto a_data = DataReader(a_sr, a_header.value<>());
+    if (!a_data) {
+        return tl::unexpected(a_data.error());
+    }
+    auto b_data = DataReader(b_sr, b_header.value<>());
+    if (!b_data) {
+        return tl::unexpected(b_data.error());
+    }
+
+    auto differences = mrb_ary_new_capa(mrb, 0);
+    std::vector<mrb_value> path;
+    auto compared = DiffRecursive(&a_data.value<>(), &b_data.value<>(), mrb, &path, differences, options, 0);
+    if (!compared) {
+        return tl::unexpected(compared.error());
+    }
+    return differences;
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicOSSP<Options>::DiffRecursive(SpanReader* a, SpanReader* b, mrb_state* mrb,
+                                                                    std::vector<mrb_value>* path, mrb_value differences,
+                                                                    const DecodeOptions& options, uint16_t depth) {
+    auto a_start = a->CurrentReadingPos();
+    auto b_start = b->CurrentReadingPos();
+    auto skipped = SkipValue(a, depth);
+    if (skipped) {
+        skipped = SkipValue(b, depth);
+    }
+    if (!skipped) {
+        return skipped;
+    }
+    auto a_size = a->CurrentReadingPos() - a_start;
+    auto b_size = b->CurrentReadingPos() - b_start;
+    if (a_size == b_size && memcmp(a->DataAt(a_start), b->DataAt(b_start), a_size) == 0) {
+        return {};
+    }
+    auto a_type = *a->DataAt(a_start);
+    auto b_type = *b->DataAt(b_start);
+    if (a_type != b_type || (a_type != ST_HASH && a_type != ST_ARRAY)) {
+        AddDifference(mrb, *path, differences);
+        return {};
+    }
+
+    // readers limited to both values, the outer ones are already behind them
+    SpanReader a_value(a->DataAt(0), a->CurrentReadingPos(), a_start + 1);
+    SpanReader b_value(b->DataAt(0), b->CurrentReadingPos(), b_start + 1);
+    if (a_type == ST_HASH) {
+        return DiffHash(&a_value, &b_value, mrb, path, differences, options, depth);
+    }
+
+    st_counter_t a_count;
+    st_counter_t b_count;
+    a_value.ReadWithEndian(&a_count, endian);
+    b_value.ReadWithEndian(&b_count, endian);
+    for (mrb_int i = 0; i < std::max(a_count, b_count); i++) {
+        path->push_back(mrb_int_value(mrb, i));
+        if (i < a_count && i < b_count) {
+            auto compared = DiffRecursive(&a_value, &b_value, mrb, path, differences, options, depth + 1);
+            if (!compared) {
+                return compared;
+            }
+        } else {
+            AddDifference(mrb, *path, differences);
+        }
+        path->pop_back();
+    }
+    return {};
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicOSSP<Options>::DiffHash(SpanReader* a, SpanReader* b, mrb_state* mrb,
+                                                               std::vector<mrb_value>* path, mrb_value differences,
+                                                               const DecodeOptions& options, uint16_t depth) {
+    struct Entry {
+        size_t key;
+        size_t value;
+        size_t end;
+    };
+    // both values were skipped once already, so reading them can not fail anymore
+    auto read_entries = [](SpanReader* sr, std::vector<Entry>* entries) {
+        st_counter_t count;
+        sr->ReadWithEndian(&count, endian);
+        entries->resize(count);
+        for (auto& entry : *entries) {
+            entry.key = sr->CurrentReadingPos();
+            (void)SkipKey(sr);
+            entry.value = sr->CurrentReadingPos();
+            (void)SkipValue(sr);
+            entry.end = sr->CurrentReadingPos();
+        }
+    };
+    std::vector<Entry> a_entries;
+    std::vector<Entry> b_entries;
+    read_entries(a, &a_entries);
+    read_entries(b, &b_entries);
+
+    auto same_bytes = [](SpanReader* a, size_t a_start, size_t a_end, SpanReader* b, size_t b_start, size_t b_end) {
+        return a_end - a_start == b_end - b_start && memcmp(a->DataAt(a_start), b->DataAt(b_start), a_end - a_start) == 0;
+    };
+    auto add_key = [&](SpanReader* sr, const Entry& entry) -> tl::expected<void, OSSPErrorInfo> {
+        sr->SetReadingPos(entry.key);
+        auto key = DecodeHashKey(sr, mrb, options);
+        if (!key) {
+            return tl::unexpected(key.error());
+        }
+        path->push_back(key.value<>());
+        return {};
+    };
+
+    auto key_bytes = [](SpanReader* sr, const Entry& entry) {
+        return std::string_view((const char*)sr->DataAt(entry.key), entry.value - entry.key);
+    };
+    // only built once the keys are not in the same order
+    std::unordered_map<std::string_view, size_t> b_index;
+
+    std::vector<bool> b_matched(b_entries.size(), false);
+    for (size_t i = 0; i < a_entries.size(); i++) {
+        auto& a_entry = a_entries[i];
+        // usually both hold their keys in the same order
+        auto match = b_entries.size();
+        if (i < b_entries.size() && same_bytes(a, a_entry.key, a_entry.value, b, b_entries[i].key, b_entries[i].value)) {
+            match = i;
+        } else {
+            if (b_index.empty()) {
+                b_index.reserve(b_entries.size());
+                for (size_t k = 0; k < b_entries.size(); k++) {
+                    b_index.emplace(key_bytes(b, b_entries[k]), k);
+                }
+            }
+            auto found = b_index.find(key_bytes(a, a_entry));
+            if (found != b_index.end() && !b_matched[found->second]) {
+                match = found->second;
+            }
+        }
+
+        if (match < b_entries.size()) {
+            b_matched[match] = true;
+            auto& b_entry = b_entries[match];
+            if (same_bytes(a, a_entry.value, a_entry.end, b, b_entry.value, b_entry.end)) {
+                continue;
+            }
+            auto added = add_key(a, a_entry);
+            if (!added) {
+                return added;
+            }
+            b->SetReadingPos(b_entry.value);
+            auto compared = DiffRecursive(a, b, mrb, path, differences, options, depth + 1);
+            path->pop_back();
+            if (!compared) {
+                return compared;
+            }
+            continue;
+        }
+        auto added = add_key(a, a_entry);
+        if (!added) {
+            return added;
+        }
+        AddDifference(mrb, *path, differences);
+        path->pop_back();
+    }
+    for (size_t k = 0; k < b_entries.size(); k++) {
+        if (b_matched[k]) {
+            continue;
+        }
+        auto added = add_key(b, b_entries[k]);
+        if (!added) {
+            return added;
+        }
+        AddDifference(mrb, *path, differences);
+        path->pop_back();
+    }
+    return {};
+}
+
+template <typename Options>
+void BasicOSSP<Options>::AddDifference(mrb_state* mrb, const std::vector<mrb_value>& path, mrb_value differences) {
+    auto difference = mrb_ary_new_capa(mrb, (mrb_int)path.size());
+    for (size_t i = 0; i < path.size(); i++) {
+        mrb_ary_set(mrb, difference, (mrb_int)i, path[i]);
+    }
+    mrb_ary_push(mrb, differences, difference);
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicOSSP<Options>::Validate(ReadBuffer* rb) {
+    SpanReader sr(rb);
+    auto header = ReadHeader(&sr);
+    if (!header) {
+        return tl::unexpected(header.error());
+    }
+    if (header->flags != Options::features) {
+        return dispatch_OSSP_features(header->flags, [&](auto features) {
+            return BasicOSSP<decltype(features)>::Validate(rb);
+        });
+    }
+
+    auto data_sr = DataReader(sr, header.value<>());
+    if (!data_sr) {
+        return tl::unexpected(data_sr.error());
+    }
+    auto skipped = SkipValue(&data_sr.value<>());
+    if (!skipped) {
+        return skipped;
+    }
+    if (data_sr->Remaining() != 0) {
+        return make_OSSP_error(OSSPUnexpectedDataError, data_sr->CurrentReadingPos());
+    }
+    return {};
+}
+
+template <typename Options>
+tl::expected<SpanReader, OSSPErrorInfo> BasicOSSP<Options>::DataReader(const SpanReader& sr, const OSSPHeader& header) {
+    // everything behind EOD is meta data, so the value itself has to end right there
+    size_t data_end = header.eod_position;
+    if constexpr (Options::checksum) {
+        uint32_t checksum;
+        if (data_end < header.data_position + sizeof(checksum)) {
+            return make_OSSP_error(OSSPReadingError, header.data_position);
+        }
+        data_end -= sizeof(checksum);
+        SpanReader checksum_sr(sr.DataAt(0), header.eod_position, data_end);
+        checksum_sr.ReadWithEndian(&checksum, header_endian);
+        if (checksum != Checksum(sr.DataAt(header.data_position), data_end - header.data_position)) {
+            return make_OSSP_error(OSSPChecksumError, data_end);
+        }
+    }
+    return SpanReader(sr.DataAt(0), data_end, header.data_position);
+}
+
+template <typename Options>
+uint32_t BasicOSSP<Options>::Checksum(const uint8_t* data, size_t size) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename Options>
+tl::expected<OSSPHeader, OSSPErrorInfo> BasicOSSP<Options>::ReadHeader(SpanReader* sr, uint64_t supported) {
+    uint32_t magic_number;
+    OSSPHeader header{};
+    if (!sr->ReadWithEndian(&magic_number, header_endian)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+
+    if (magic_number != LE_MAGIC_NUMBER) {
+        return make_OSSP_error(OSSPMagicNumberError, sr->CurrentReadingPos());
+    }
+
+    if (!sr->ReadWithEndian(&header.eod_position, header_endian)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+
+    if (!sr->ReadWithEndian(&header.flags, header_endian)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+
+    if ((header.flags & ~supported) != 0) {
+        return make_OSSP_error(OSSPUnsupportedFeaturesError, sr->CurrentReadingPos());
+    }
+    header.data_position = sr->CurrentReadingPos();
+
+    auto bb_size = sr->Size();
+    auto eod_len = strlen(END_OF_DATA);
+    auto eof_len = strlen(END_OF_FILE);
+    if (bb_size < eof_len || header.eod_position < header.data_position || header.eod_position > bb_size - eof_len) {
+        return make_OSSP_error(OSSPWrongBufferSizeError, sr->CurrentReadingPos());
+    }
+
+    auto first_end_content = (const char*)sr->DataAt(header.eod_position);
+    if (memcmp(first_end_content, END_OF_DATA, eod_len) == 0) {
+        header.has_meta_data = true;
+    } else if (memcmp(first_end_content, END_OF_FILE, eof_len) != 0) {
+        return make_OSSP_error(OSSPEOFError, header.eod_position);
+    }
+
+    if (header.has_meta_data) {
+        auto read_bb_end_pos = bb_size - eof_len;
+        if (read_bb_end_pos < header.eod_position + eod_len ||
+            memcmp(sr->DataAt(read_bb_end_pos), END_OF_FILE, eof_len) != 0) {
+            return make_OSSP_error(OSSPEOFError, read_bb_end_pos);
+        }
+        header.meta_data_position = header.eod_position + eod_len;
+        header.meta_data_size = read_bb_end_pos - header.meta_data_position;
+    }
+
+    return header;
+}
+
+template <typename Options>
+bool BasicOSSP<Options>::SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options) {
+    if (options.cache != nullptr && EncodeCache::IsCandidate(data)) {
+        return SerializeCached(bb, mrb, data, options);
+    }
+    return SerializeValue(bb, mrb, data, options);
+}
+
+template <typename Options>
+bool BasicOSSP<Options>::SerializeCached(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options) {
+    auto cached = options.cache->Find(data, Options::features, options);
+    if (cached != nullptr) {
+        bb->Append((char*)cached->data(), cached->size());
+        return true;
+    }
+    // nested frozen containers are looked up on the way, so their bytes end up in both entries
+    auto start = bb->Size();
+    auto frozen = SerializeValue(bb, mrb, data, options);
+    if (frozen) {
+        options.cache->Store(data, Options::features, options, (const uint8_t*)bb->DataAt(start), bb->Size() - start);
+    }
+    return frozen;
+}
+
+template <typename Options>
+bool BasicOSSP<Options>::SerializeValue(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const EncodeOptions& options) {
+    // objects, records and typed arrays may change even when frozen
+    if (options.records != nullptr) {
+        auto record = options.records->Find(data);
+        if (record != nullptr) {
+            SerializeRecord(bb, mrb, data, *record, options);
+            return false;
+        }
+    }
+    auto typed_array = get_OSSP_typed_array(data);
+    if (typed_array != nullptr) {
+        SerializeTypedArray(bb, typed_array);
+        return false;
+    }
+    if (get_OSSP_tracked(data) != nullptr) {
+        SerializeValue(bb, mrb, get_OSSP_tracked_data(mrb, data), options);
+        return false;
+    }
     auto stype = GetType(data);
     auto type = (uint8_t)stype;
+    auto frozen = true;
     if (stype == ST_FALSE || stype == ST_TRUE || stype == ST_NIL) {
         bb->AppendWithEndian((uint8_t)type, endian);
     } else if (stype == ST_INT) {
         mrb_int number = cext_to_int(mrb, data);
-        #ifdef ADV_SER
-        split_int64_auto(number, bb);
-        #else
-        bb->AppendWithEndian((uint8_t)ST_INT, endian);
-        bb->AppendWithEndian(number, endian);
-        #endif
+        if constexpr (Options::int_encoding == IntEncoding::Compact) {
+            SplitInt64(number, bb);
+        } else {
+            bb->AppendWithEndian((uint8_t)ST_INT, endian);
+            bb->AppendWithEndian(number, endian);
+        }
     } else if (stype == ST_FLOAT) {
         mrb_float number = cext_to_float(mrb, data);
         bb->AppendWithEndian((uint8_t)ST_FLOAT, endian);
@@ -122,6 +1084,7 @@ void OSSP::SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data) {
         bb->AppendWithEndian((uint8_t)ST_STRING, endian);
         bb->AppendWithEndian(str_len, endian);
         bb->Append((char*)string, str_len);
+        frozen = MRB_FROZEN_P(mrb_basic_ptr(data));
     } else if (stype == ST_SYMBOL) {
         const char* string = mrb_sym_name(mrb, mrb_obj_to_sym(mrb, data));
         st_counter_t str_len = strlen(string); // + 1; we SKIP this intentionally
@@ -132,11 +1095,18 @@ void OSSP::SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data) {
         bb->AppendWithEndian((uint8_t)ST_ARRAY, endian);
         st_counter_t array_size = RARRAY_LEN(data);
         bb->AppendWithEndian(array_size, endian);
+        frozen = MRB_FROZEN_P(mrb_basic_ptr(data));
         for (mrb_int i = 0; i < array_size; i++) {
             auto object = RARRAY_PTR(data)[i];
-            SerializeRecursive(bb, mrb, object);
+            frozen = SerializeRecursive(bb, mrb, object, options) && frozen;
         }
     } else if (stype == ST_HASH) {
+        if (options.tables != nullptr) {
+            auto layout = options.tables->Find(mrb, data);
+            if (layout != nullptr) {
+                return SerializeTable(bb, mrb, data, *layout, options) && MRB_FROZEN_P(mrb_basic_ptr(data));
+            }
+        }
         bb->AppendWithEndian((uint8_t)ST_HASH, endian);
         auto current_pos = bb->CurrentReadingPos();
         auto hash = mrb_hash_ptr(data);
@@ -146,247 +1116,719 @@ void OSSP::SerializeRecursive(ByteBuffer* bb, mrb_state* mrb, mrb_value data) {
 
         typedef struct to_pass_t {
             ByteBuffer* buffer;
+            const EncodeOptions* options;
+            bool frozen;
         } to_pass_t;
-        to_pass_t to_pass = {bb};
+        to_pass_t to_pass = {bb, &options, MRB_FROZEN_P(mrb_basic_ptr(data)) != 0};
 
         mrb_hash_foreach(mrb, hash, {[](mrb_state* intern_state, mrb_value key, mrb_value val, void* passed) -> int {
             auto to_pass = (to_pass_t*)passed;
             auto bb = to_pass->buffer;
 
             if (AddHashKey(bb, intern_state, key)) {
-                SerializeRecursive(bb, intern_state, val);
+                // written keys are immutable apart from Strings
+                auto frozen_key = !mrb_string_p(key) || MRB_FROZEN_P(mrb_basic_ptr(key));
+                auto frozen_value = SerializeRecursive(bb, intern_state, val, *to_pass->options);
+                to_pass->frozen = to_pass->frozen && frozen_key && frozen_value;
+            } else {
+                to_pass->frozen = false;
             }
             return 0;
         }}, &to_pass);
+        frozen = to_pass.frozen;
+    }
+    return frozen;
+}
+
+template <typename Options>
+void BasicOSSP<Options>::SerializeTypedArray(ByteBuffer* bb, const TypedArray* array) {
+    auto type = array->type == TypedArrayType::Float64 ? ST_FLOAT64_ARRAY : ST_INT64_ARRAY;
+    bb->AppendWithEndian((uint8_t)type, endian);
+    bb->AppendWithEndian((st_block_counter_t)array->size, endian);
+    if ((endian == Little) == SpanReader::HostIsLittleEndian()) {
+        bb->Append((char*)array->data, array->size * sizeof(uint64_t));
+        return;
+    }
+    auto elements = (const uint64_t*)array->data;
+    for (size_t i = 0; i < array->size; i++) {
+        bb->AppendWithEndian(elements[i], endian);
+    }
+}
+
+template <typename Options>
+void BasicOSSP<Options>::SerializeRecord(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const RecordTable::Record& record,
+                                         const EncodeOptions& options) {
+    bb->AppendWithEndian((uint8_t)ST_HASH, endian);
+    st_counter_t hash_size = record.keys.size();
+    bb->AppendWithEndian(hash_size, endian);
+    for (st_counter_t i = 0; i < hash_size; i++) {
+        if (AddHashKey(bb, mrb, mrb_symbol_value(record.keys[i]))) {
+            SerializeRecursive(bb, mrb, mrb_iv_get(mrb, data, record.ivars[i]), options);
+        }
+    }
+}
+
+template <typename Options>
+bool BasicOSSP<Options>::SerializeTable(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const TableLayouts::Layout& layout,
+                                        const EncodeOptions& options) {
+    auto position = bb->Size();
+    st_counter_t fields = layout.keys.size();
+    bb->AppendWithEndian((uint8_t)ST_TABLE, endian);
+    bb->AppendWithEndian((st_block_counter_t)0, endian);
+    bb->AppendWithEndian(layout.id, endian);
+    bb->AppendWithEndian(fields, endian);
+    auto offsets = bb->Size();
+    for (st_counter_t i = 0; i < fields; i++) {
+        bb->AppendWithEndian((st_block_counter_t)0, endian);
+    }
+    auto frozen = true;
+    for (st_counter_t i = 0; i < fields; i++) {
+        auto offset = (st_block_counter_t)(bb->Size() - position);
+        bb->SetAtWithEndian(offsets + i * sizeof(st_block_counter_t), offset, endian);
+        auto key = mrb_symbol_value(layout.keys[i]);
+        if (AddHashKey(bb, mrb, key)) {
+            frozen = SerializeRecursive(bb, mrb, mrb_hash_get(mrb, data, key), options) && frozen;
+        }
+    }
+    bb->SetAtWithEndian(position + 1, (st_block_counter_t)(bb->Size() - position), endian);
+    return frozen;
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DeserializeRecursive(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options,
+                                                                                uint16_t depth) {
+    if (sr->Remaining() == 0) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    uint8_t bin_type;
+    sr->ReadUnchecked(&bin_type, endian);
+    return decode_handlers[bin_type](sr, mrb, options, depth);
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::SetHashKey(SpanReader* sr, mrb_state* state, mrb_value hash, const DecodeOptions& options,
+                                                                      uint16_t depth) {
+    auto key = DecodeHashKey(sr, state, options, depth);
+    if (!key) {
+        return key;
+    }
+    auto data = DeserializeRecursive(sr, state, options, depth);
+    if (!data) {
+        return data;
     }
+    mrb_hash_set(state, hash, key.value<>(), data.value<>());
+    return {};
 }
 
-tl::expected<mrb_value, OSSPErrorInfo> OSSP::DeserializeRecursive(ReadBuffer* rb, mrb_state* mrb) {
-uint8_t bin_type;
-    if (!rb->ReadWithEndian(&bin_type, endian)) {
-        auto error = OSSPReadingError;
-        error.position = rb->CurrentReadingPos();
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeHashKey(SpanReader* sr, mrb_state* state, const DecodeOptions& options,
+                                                                         uint16_t depth) {
+    if (sr->Remaining() == 0) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    uint8_t key_type;
+    sr->ReadUnchecked(&key_type, endian);
+    if (!IsKeyType(key_type)) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, sr->CurrentReadingPos());
+    }
+
+    // strings and symbols share their encoding, so converting is just picking the other handler
+    if (options.keys == KeyConversion::Symbolize && key_type == ST_STRING) {
+        key_type = ST_SYMBOL;
+    } else if (options.keys == KeyConversion::Stringify && key_type == ST_SYMBOL) {
+        key_type = ST_STRING;
+    }
+
+    return decode_handlers[key_type](sr, state, options, depth);
+}
+
+template <typename Options>
+tl::unexpected<OSSPErrorInfo> BasicOSSP<Options>::DecodeFailure(const OSSPErrorInfo& error, size_t position) {
+    if (error.type == OSSPErrorType::MaxDepthExceeded) {
         return tl::unexpected(error);
     }
-    auto type = (serialized_type)bin_type;
+    return make_OSSP_error(OSSPReadingError, position);
+}
 
-    if (type == ST_FALSE) {
-        return mrb_false_value();
+template <typename Options>
+bool BasicOSSP<Options>::IsKeyType(uint8_t type) {
+    return type == ST_STRING || type == ST_SYMBOL || type == ST_INT || type == ST_FLOAT ||
+           (type >= ST_ADV_BYTE_1 && type <= ST_ADV_BYTE_8);
+}
+
+// All handlers are called with the type byte already consumed.
+// Fixed size payloads are bounds checked once and then read unchecked.
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeFalse(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    return mrb_false_value();
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeTrue(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    return mrb_true_value();
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeNil(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    return mrb_nil_value();
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeInt(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    if (sr->Remaining() < sizeof(mrb_int)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
     }
+    mrb_int num;
+    sr->ReadUnchecked(&num, endian);
+    return mrb_int_value(mrb, num);
+}
 
-    if (type == ST_TRUE) {
-        return mrb_true_value();
+template <typename Options>
+template <uint8_t N>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeCompactInt(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    int64_t value;
+    if (!ReadCompactInt(sr, N, &value)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
     }
+    return mrb_int_value(mrb, (mrb_int)value);
+}
 
-    if (type == ST_NIL) {
-        return mrb_nil_value();
+template <typename Options>
+bool BasicOSSP<Options>::ReadCompactInt(SpanReader* sr, uint8_t n_bytes, int64_t* value) {
+    if (sr->Remaining() < n_bytes) {
+        return false;
+    }
+    // Big Endian: MSB first, the highest bit carries the sign
+    auto bytes = sr->Current();
+    uint64_t bits = (bytes[0] & 0x80) ? ~0ULL : 0;
+    for (size_t i = 0; i < n_bytes; i++) {
+        bits = (bits << 8) | bytes[i];
     }
+    sr->Skip(n_bytes);
+    *value = (int64_t)bits;
+    return true;
+}
 
-    if (type == ST_STRING) {
-        st_counter_t data_size;
-        if (!rb->ReadWithEndian(&data_size, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
-        }
-        auto str_ptr = mrb_malloc(mrb, data_size);
-        if (!rb->Read((char*)str_ptr, data_size)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeFloat(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    if (sr->Remaining() < sizeof(mrb_float)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    mrb_float num;
+    sr->ReadUnchecked(&num, endian);
+    return mrb_float_value(mrb, num);
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeString(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    auto data = ReadCounted(sr);
+    if (!data) {
+        return tl::unexpected(data.error());
+    }
+    if (options.zero_copy && mrb_string_p(options.source) && data->size() > RSTRING_EMBED_LEN_MAX) {
+        // shares the buffer of source, which stays alive as long as any of these strings does
+        auto offset = data->data() - RSTRING_PTR(options.source);
+        return mrb_str_byte_subseq(mrb, options.source, offset, (mrb_int)data->size());
+    }
+    if (options.strings != nullptr) {
+        return options.strings->Get(mrb, data->data(), data->size());
+    }
+    return mrb_str_new(mrb, data->data(), data->size());
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeSymbol(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    auto data = ReadCounted(sr);
+    if (!data) {
+        return tl::unexpected(data.error());
+    }
+    return mrb_symbol_value(mrb_intern(mrb, data->data(), data->size()));
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeHash(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    if (depth >= max_depth) {
+        return make_OSSP_error(OSSPMaxDepthError, sr->CurrentReadingPos());
+    }
+    if (sr->Remaining() < sizeof(st_counter_t)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    st_counter_t hash_size;
+    sr->ReadUnchecked(&hash_size, endian);
+    return DecodeHashEntries(sr, mrb, hash_size, options, depth + 1);
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeTable(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    if (depth >= max_depth) {
+        return make_OSSP_error(OSSPMaxDepthError, sr->CurrentReadingPos());
+    }
+    auto table = ReadTable(sr);
+    if (!table) {
+        return tl::unexpected(table.error());
+    }
+    // the entries are stored like the ones of a Hash, the offsets are only needed for random access
+    auto decoded = DecodeHashEntries(sr, mrb, table->fields, options, depth + 1);
+    if (decoded && sr->CurrentReadingPos() != table->position + table->size) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    return decoded;
+}
+
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeHashEntries(SpanReader* sr, mrb_state* mrb, st_counter_t hash_size,
+                                                                           const DecodeOptions& options, uint16_t depth) {
+    if (options.records != nullptr && options.records->MayMatch(hash_size)) {
+        return DecodeRecord(sr, mrb, hash_size, options, depth);
+    }
+    mrb_value hash = mrb_hash_new_capa(mrb, hash_size);
+
+    for (st_counter_t i = 0; i < hash_size; ++i) {
+        auto success = SetHashKey(sr, mrb, hash, options, depth);
+        if (!success) {
+            return DecodeFailure(success.error(), sr->CurrentReadingPos());
         }
-        mrb_value data = mrb_str_new(mrb, (const char*)str_ptr, data_size);
-        mrb_free(mrb, str_ptr);
-        return data;
     }
+    return hash;
+}
 
-    if (type == ST_SYMBOL) {
-        st_counter_t data_size;
-        if (!rb->ReadWithEndian(&data_size, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeRecord(SpanReader* sr, mrb_state* mrb, st_counter_t hash_size,
+                                                                      const DecodeOptions& options, uint16_t depth) {
+    // the decoded values stay alive in the GC arena until the caller is done
+    std::vector<mrb_value> entries(hash_size * 2);
+    for (st_counter_t i = 0; i < hash_size; ++i) {
+        auto key = DecodeHashKey(sr, mrb, options, depth);
+        if (!key) {
+            return DecodeFailure(key.error(), sr->CurrentReadingPos());
         }
-        auto str_ptr = mrb_malloc(mrb, data_size);
-        if (!rb->Read((char*)str_ptr, data_size)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+        auto data = DeserializeRecursive(sr, mrb, options, depth);
+        if (!data) {
+            return DecodeFailure(data.error(), sr->CurrentReadingPos());
         }
-        auto sym = mrb_intern_str(mrb, mrb_str_new(mrb, (const char*)str_ptr, data_size));
-        auto data = mrb_symbol_value(sym);
-        mrb_free(mrb, str_ptr);
-        return data;
+        entries[i * 2] = key.value<>();
+        entries[i * 2 + 1] = data.value<>();
     }
 
-    if (type == ST_INT) {
-        mrb_int num;
-        if (!rb->ReadWithEndian(&num, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+    auto record = options.records->Materialize(mrb, entries.data(), hash_size);
+    if (!mrb_nil_p(record)) {
+        return record;
+    }
+    mrb_value hash = mrb_hash_new_capa(mrb, hash_size);
+    for (st_counter_t i = 0; i < hash_size; ++i) {
+        mrb_hash_set(mrb, hash, entries[i * 2], entries[i * 2 + 1]);
+    }
+    return hash;
+}
+
+template <typename Options>
+template <TypedArrayType Type>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeTypedArray(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    st_block_counter_t size;
+    if (!sr->ReadWithEndian(&size, endian) || sr->Remaining() / sizeof(uint64_t) < size) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+
+    TypedArray* array;
+    auto typed_array = new_OSSP_typed_array(mrb, Type, size, &array);
+    if (mrb_nil_p(typed_array)) {
+        // the typed array classes are not defined, fall back to a plain Array
+        mrb_value plain = mrb_ary_new_capa(mrb, size);
+        for (st_block_counter_t i = 0; i < size; ++i) {
+            if constexpr (Type == TypedArrayType::Float64) {
+                double value;
+                sr->ReadUnchecked(&value, endian);
+                mrb_ary_set(mrb, plain, i, mrb_float_value(mrb, value));
+            } else {
+                int64_t value;
+                sr->ReadUnchecked(&value, endian);
+                mrb_ary_set(mrb, plain, i, mrb_int_value(mrb, (mrb_int)value));
+            }
         }
-        return mrb_int_value(mrb, num);
+        return plain;
     }
 
-    if (type == ST_FLOAT) {
-        mrb_float num;
-        if (!rb->ReadWithEndian(&num, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+    if ((endian == Little) == SpanReader::HostIsLittleEndian()) {
+        memcpy(array->data, sr->Current(), size * sizeof(uint64_t));
+        sr->Skip(size * sizeof(uint64_t));
+    } else {
+        auto elements = (uint64_t*)array->data;
+        for (st_block_counter_t i = 0; i < size; ++i) {
+            sr->ReadUnchecked(&elements[i], endian);
         }
-        return mrb_float_value(mrb, num);
     }
+    return typed_array;
+}
 
-    if (type == ST_HASH) {
-        st_counter_t hash_size;
-        if (!rb->ReadWithEndian(&hash_size, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeArray(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    if (depth >= max_depth) {
+        return make_OSSP_error(OSSPMaxDepthError, sr->CurrentReadingPos());
+    }
+    if (sr->Remaining() < sizeof(st_counter_t)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    st_counter_t array_size;
+    sr->ReadUnchecked(&array_size, endian);
+    mrb_value array = mrb_ary_new_capa(mrb, array_size);
+
+    for (st_counter_t i = 0; i < array_size; ++i) {
+        auto data = DeserializeRecursive(sr, mrb, options, depth + 1);
+        if (!data) {
+            return data;
         }
-        mrb_value hash = mrb_hash_new_capa(mrb, hash_size);
+        mrb_ary_set(mrb, array, i, data.value<>());
+    }
+    return array;
+}
 
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::DecodeInvalid(SpanReader* sr, mrb_state* mrb, const DecodeOptions& options, uint16_t depth) {
+    return make_OSSP_error(OSSPErrorInfoInvalidType, sr->CurrentReadingPos());
+}
+
+template <typename Options>
+tl::expected<std::string_view, OSSPErrorInfo> BasicOSSP<Options>::ReadCounted(SpanReader* sr) {
+    if (sr->Remaining() < sizeof(st_counter_t)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    st_counter_t data_size;
+    sr->ReadUnchecked(&data_size, endian);
+    if (sr->Remaining() < data_size) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    auto data = sr->Current();
+    sr->Skip(data_size);
+    return std::string_view((const char*)data, data_size);
+}
+
+template <typename Options>
+constexpr std::array<typename BasicOSSP<Options>::DecodeHandler, 256> BasicOSSP<Options>::CreateDecodeHandlers() {
+    std::array<DecodeHandler, 256> handlers{};
+    for (auto& handler : handlers) {
+        handler = DecodeInvalid;
+    }
+    handlers[ST_FALSE] = DecodeFalse;
+    handlers[ST_TRUE] = DecodeTrue;
+    handlers[ST_INT] = DecodeInt;
+    handlers[ST_FLOAT] = DecodeFloat;
+    handlers[ST_SYMBOL] = DecodeSymbol;
+    handlers[ST_HASH] = DecodeHash;
+    handlers[ST_ARRAY] = DecodeArray;
+    handlers[ST_STRING] = DecodeString;
+    handlers[ST_NIL] = DecodeNil;
+    handlers[ST_FLOAT64_ARRAY] = DecodeTypedArray<TypedArrayType::Float64>;
+    handlers[ST_INT64_ARRAY] = DecodeTypedArray<TypedArrayType::Int64>;
+    handlers[ST_TABLE] = DecodeTable;
+    handlers[ST_EOD] = DecodeNil;
+    handlers[ST_ADV_BYTE_1] = DecodeCompactInt<1>;
+    handlers[ST_ADV_BYTE_2] = DecodeCompactInt<2>;
+    handlers[ST_ADV_BYTE_3] = DecodeCompactInt<3>;
+    handlers[ST_ADV_BYTE_4] = DecodeCompactInt<4>;
+    handlers[ST_ADV_BYTE_5] = DecodeCompactInt<5>;
+    handlers[ST_ADV_BYTE_6] = DecodeCompactInt<6>;
+    handlers[ST_ADV_BYTE_7] = DecodeCompactInt<7>;
+    handlers[ST_ADV_BYTE_8] = DecodeCompactInt<8>;
+    return handlers;
+}
+
+template <typename Options>
+const std::array<typename BasicOSSP<Options>::DecodeHandler, 256> BasicOSSP<Options>::decode_handlers =
+    CreateDecodeHandlers();
+
+template <typename Options>
+tl::expected<bool, OSSPErrorInfo> BasicOSSP<Options>::SeekChild(SpanReader* sr, mrb_state* mrb, mrb_value step) {
+    uint8_t bin_type;
+    if (!sr->ReadWithEndian(&bin_type, endian)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+
+    if (bin_type == ST_HASH) {
+        st_counter_t hash_size;
+        if (!sr->ReadWithEndian(&hash_size, endian)) {
+            return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+        }
         for (st_counter_t i = 0; i < hash_size; ++i) {
-            auto success = SetHashKey(rb, mrb, hash);
-            if (!success) {
-                auto error = OSSPReadingError;
-                error.position = rb->CurrentReadingPos();
-                return tl::unexpected(error);
+            auto matches = MatchKey(sr, mrb, step);
+            if (!matches) {
+                return matches;
+            }
+            if (matches.value<>()) {
+                return true;
+            }
+            auto skipped = SkipValue(sr);
+            if (!skipped) {
+                return tl::unexpected(skipped.error());
             }
         }
-        return hash;
+        return false;
     }
 
-    if (type == ST_ARRAY) {
-        st_counter_t array_size;
-        if (!rb->ReadWithEndian(&array_size, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+    if (bin_type == ST_TABLE) {
+        auto table = ReadTable(sr);
+        if (!table) {
+            return tl::unexpected(table.error());
         }
-        mrb_value array = mrb_ary_new_capa(mrb, array_size);
-
-        for (st_counter_t i = 0; i < array_size; ++i) {
-            auto data = DeserializeRecursive(rb, mrb);
-            if (!data) {
-                return data;
+        // only the keys get compared, the offsets jump over all values in between
+        for (st_counter_t i = 0; i < table->fields; ++i) {
+            auto seeked = SeekTableEntry(sr, table.value(), i);
+            if (!seeked) {
+                return tl::unexpected(seeked.error());
+            }
+            auto matches = MatchKey(sr, mrb, step);
+            if (!matches || matches.value()) {
+                return matches;
             }
-            mrb_ary_set(mrb, array, i, data.value<>());
         }
-        return array;
+        return false;
     }
 
-    if (type == ST_EOD) {
-        return mrb_nil_value();
+    if (bin_type == ST_ARRAY) {
+        st_counter_t array_size;
+        if (!sr->ReadWithEndian(&array_size, endian)) {
+            return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+        }
+        if (GetType(step) != ST_INT) {
+            return false;
+        }
+        mrb_int index = cext_to_int(mrb, step);
+        if (index < 0) {
+            index += array_size;
+        }
+        if (index < 0 || index >= array_size) {
+            return false;
+        }
+        for (mrb_int i = 0; i < index; i++) {
+            auto skipped = SkipValue(sr);
+            if (!skipped) {
+                return tl::unexpected(skipped.error());
+            }
+        }
+        return true;
     }
 
-    auto error = OSSPErrorInfoInvalidType;
-    error.position = rb->CurrentReadingPos();
-    return tl::unexpected(error);
+    // scalars have no children
+    return false;
 }
 
-tl::expected<mrb_value, OSSPErrorInfo> OSSP::SetHashKey(ReadBuffer* rb, mrb_state* state, mrb_value hash) {
-    serialized_type key_type;
-    if (!rb->ReadWithEndian((uint8_t*)&key_type, endian)) {
-        auto error = OSSPReadingError;
-        error.position = rb->CurrentReadingPos();
-        return tl::unexpected(error);
+template <typename Options>
+tl::expected<bool, OSSPErrorInfo> BasicOSSP<Options>::MatchKey(SpanReader* sr, mrb_state* mrb, mrb_value key) {
+    uint8_t key_type;
+    if (!sr->ReadWithEndian(&key_type, endian)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
     }
-    mrb_value key;
+    auto wanted_type = GetType(key);
 
-    if (key_type == ST_STRING) {
-        st_counter_t key_size;
-        if (!rb->ReadWithEndian(&key_size, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
-        }
-        auto str_ptr = mrb_malloc(state, key_size);
-        if (!rb->Read((char*)str_ptr, key_size)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
-        }
-        key = mrb_str_new(state, (const char*)str_ptr, key_size);
-        mrb_free(state, str_ptr);
-    } else if (key_type == ST_SYMBOL) {
-        st_counter_t key_size;
-        if (!rb->ReadWithEndian(&key_size, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
-        }
-        auto str_ptr = mrb_malloc(state, key_size);
-        if (!rb->Read((char*)str_ptr, key_size)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
-        }
-        auto sym = mrb_intern_str(state, mrb_str_new(state, (const char*)str_ptr, key_size));
-        key = mrb_symbol_value(sym);
-        mrb_free(state, str_ptr);
-    } else if (key_type == ST_INT) {
-        mrb_int num_key;
-        if (!rb->ReadWithEndian(&num_key, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+    if (key_type == ST_STRING || key_type == ST_SYMBOL) {
+        auto key_data = ReadCounted(sr);
+        if (!key_data) {
+            return tl::unexpected(key_data.error());
         }
-        key = mrb_int_value(state, num_key);
-    } else if (key_type == ST_FLOAT) {
-        mrb_float num_key;
-        if (!rb->ReadWithEndian(&num_key, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+        if (wanted_type != key_type) {
+            return false;
+        }
+        const char* wanted_ptr;
+        mrb_int wanted_size;
+        if (wanted_type == ST_STRING) {
+            wanted_ptr = RSTRING_PTR(key);
+            wanted_size = RSTRING_LEN(key);
+        } else {
+            wanted_ptr = mrb_sym_name_len(mrb, mrb_symbol(key), &wanted_size);
         }
-        key = mrb_float_value(state, num_key);
-    } else if (key_type >= ST_ADV_BYTE_1 && key_type <= ST_ADV_BYTE_8) {
-        auto num_bytes = key_type - ST_ADV_BYTE_1 + 1;
-        int64_t value = 0;
-        uint8_t byte;
-        // first byte is sign
-        //int8_t first_byte = (int8_t)buffer[1];
-        if (!rb->ReadWithEndian(&byte, endian)) {
-            auto error = OSSPReadingError;
-            error.position = rb->CurrentReadingPos();
-            return tl::unexpected(error);
+        return key_data.value<>() == std::string_view(wanted_ptr, wanted_size);
+    }
+
+    if (key_type == ST_INT) {
+        mrb_int num_key;
+        if (!sr->ReadWithEndian(&num_key, endian)) {
+            return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
         }
+        return wanted_type == ST_INT && cext_to_int(mrb, key) == num_key;
+    }
 
-        // add sign for negative numbers
-        if (byte < 0) {
-            value = -1LL; // Set all bits to 1
+    if (key_type >= ST_ADV_BYTE_1 && key_type <= ST_ADV_BYTE_8) {
+        int64_t num_key;
+        if (!ReadCompactInt(sr, key_type - ST_ADV_BYTE_1 + 1, &num_key)) {
+            return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
         }
+        return wanted_type == ST_INT && cext_to_int(mrb, key) == num_key;
+    }
 
-        // read bytes left to right (Big Endian)
-        for (size_t i = 0; i < num_bytes; i++) {
-            if (!rb->ReadWithEndian(&byte, endian)) {
-                auto error = OSSPReadingError;
-                error.position = rb->CurrentReadingPos();
-                return tl::unexpected(error);
+    if (key_type == ST_FLOAT) {
+        mrb_float num_key;
+        if (!sr->ReadWithEndian(&num_key, endian)) {
+            return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+        }
+        return wanted_type == ST_FLOAT && cext_to_float(mrb, key) == num_key;
+    }
+
+    return make_OSSP_error(OSSPErrorInfoInvalidType, sr->CurrentReadingPos());
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicOSSP<Options>::SkipKey(SpanReader* sr, uint16_t depth) {
+    if (sr->Remaining() == 0) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    if (!IsKeyType(*sr->Current())) {
+        return make_OSSP_error(OSSPErrorInfoInvalidType, sr->CurrentReadingPos());
+    }
+    return SkipValue(sr, depth);
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicOSSP<Options>::SkipValue(SpanReader* sr, uint16_t depth) {
+    uint8_t bin_type;
+    if (!sr->ReadWithEndian(&bin_type, endian)) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    auto type = (serialized_type)bin_type;
+
+    switch (type) {
+        case ST_FALSE:
+        case ST_TRUE:
+        case ST_NIL:
+        case ST_EOD:
+            return {};
+        case ST_INT:
+            if (!sr->Skip(sizeof(mrb_int))) {
+                return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+            }
+            return {};
+        case ST_FLOAT:
+            if (!sr->Skip(sizeof(mrb_float))) {
+                return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+            }
+            return {};
+        case ST_STRING:
+        case ST_SYMBOL: {
+            auto data = ReadCounted(sr);
+            if (!data) {
+                return tl::unexpected(data.error());
+            }
+            return {};
+        }
+        case ST_FLOAT64_ARRAY:
+        case ST_INT64_ARRAY: {
+            st_block_counter_t size;
+            if (!sr->ReadWithEndian(&size, endian) || !sr->Skip((size_t)size * sizeof(uint64_t))) {
+                return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+            }
+            return {};
+        }
+        case ST_ARRAY: {
+            st_counter_t array_size;
+            if (depth >= max_depth) {
+                return make_OSSP_error(OSSPMaxDepthError, sr->CurrentReadingPos());
+            }
+            // every element needs at least its type byte
+            if (!sr->ReadWithEndian(&array_size, endian) || sr->Remaining() < array_size) {
+                return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+            }
+            for (st_counter_t i = 0; i < array_size; ++i) {
+                auto skipped = SkipValue(sr, depth + 1);
+                if (!skipped) {
+                    return skipped;
+                }
+            }
+            return {};
+        }
+        case ST_HASH: {
+            st_counter_t hash_size;
+            if (depth >= max_depth) {
+                return make_OSSP_error(OSSPMaxDepthError, sr->CurrentReadingPos());
+            }
+            // every pair needs at least a key and a value type byte
+            if (!sr->ReadWithEndian(&hash_size, endian) || sr->Remaining() / 2 < hash_size) {
+                return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+            }
+            for (st_counter_t i = 0; i < hash_size; ++i) {
+                auto skipped = SkipKey(sr, depth + 1);
+                if (skipped) {
+                    skipped = SkipValue(sr, depth + 1);
+                }
+                if (!skipped) {
+                    return skipped;
+                }
+            }
+            return {};
+        }
+        case ST_TABLE: {
+            if (depth >= max_depth) {
+                return make_OSSP_error(OSSPMaxDepthError, sr->CurrentReadingPos());
+            }
+            auto table = ReadTable(sr);
+            if (!table) {
+                return tl::unexpected(table.error());
+            }
+            // walked like a Hash, so Validate checks the entries as well
+            for (st_counter_t i = 0; i < table->fields; ++i) {
+                auto skipped = SkipKey(sr, depth + 1);
+                if (skipped) {
+                    skipped = SkipValue(sr, depth + 1);
+                }
+                if (!skipped) {
+                    return skipped;
+                }
             }
-            value = (value << 8) | byte;
+            if (sr->CurrentReadingPos() != table->position + table->size) {
+                return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+            }
+            return {};
         }
+        default:
+            break;
+    }
 
-        //bb->ReadWithEndian(&num_key, endian);
-        //key = mrb_int_value(state, num_key);
-    } else {
-        auto error = OSSPErrorInfoInvalidType;
-        error.position = rb->CurrentReadingPos();
-        return tl::unexpected(error);
+    if (type >= ST_ADV_BYTE_1 && type <= ST_ADV_BYTE_8) {
+        if (!sr->Skip(type - ST_ADV_BYTE_1 + 1)) {
+            return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+        }
+        return {};
     }
 
-    auto data = DeserializeRecursive(rb, state);
-    if (!data) {
-        return data;
+    return make_OSSP_error(OSSPErrorInfoInvalidType, sr->CurrentReadingPos());
+}
+
+template <typename Options>
+tl::expected<OSSPTable, OSSPErrorInfo> BasicOSSP<Options>::ReadTable(SpanReader* sr) {
+    OSSPTable table;
+    table.position = sr->CurrentReadingPos() - 1;
+    if (sr->Remaining() < TableLayouts::header_size - 1) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    sr->ReadUnchecked(&table.size, endian);
+    sr->ReadUnchecked(&table.layout, endian);
+    sr->ReadUnchecked(&table.fields, endian);
+    // every entry needs its offset, a key and a value type byte
+    auto min_size = TableLayouts::header_size + (size_t)table.fields * (sizeof(st_block_counter_t) + 2);
+    if (table.size < min_size || table.size > sr->Size() - table.position) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
+    }
+    sr->Skip((size_t)table.fields * sizeof(st_block_counter_t));
+    return table;
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicOSSP<Options>::SeekTableEntry(SpanReader* sr, const OSSPTable& table, st_counter_t index) {
+    if (index >= table.fields) {
+        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());
     }
-    mrb_hash_set(state, hash, key, data.value<>());
+    SpanReader offsets(sr->DataAt(0), sr->Size(), table.position + TableLayouts::header_size + index * sizeof(st_block_counter_t));
+    st_block_counter_t offset;
+    offsets.ReadUnchecked(&offset, endian);
+    // an entry has at least a key and a value type byte
+    auto entries = TableLayouts::header_size + (size_t)table.fields * sizeof(st_block_counter_t);
+    if (offset < entries || offset > table.size - 2) {
+        return make_OSSP_error(OSSPReadingError, offsets.CurrentReadingPos());
+    }
+    sr->SetReadingPos(table.position + offset);
     return {};
 }
 
-tl::expected<mrb_value, OSSPErrorInfo> OSSP::AddHashKey(ByteBuffer* bb, mrb_state* state, mrb_value key) {
+template <typename Options>
+tl::expected<mrb_value, OSSPErrorInfo> BasicOSSP<Options>::AddHashKey(ByteBuffer* bb, mrb_state* state, mrb_value key) {
     auto key_type = GetType(key);
 
     if (key_type == ST_STRING) {
@@ -403,13 +1845,12 @@ tl::expected<mrb_value, OSSPErrorInfo> OSSP::AddHashKey(ByteBuffer* bb, mrb_stat
         bb->Append((char*)s_key, str_len);
     } else if (key_type == ST_INT) {
         auto num_key = cext_to_int(state, key);
-
-        #ifdef ADV_SER
-        split_int64_auto(num_key, bb);
-        #else
-        bb->AppendWithEndian((uint8_t)ST_INT, endian);
-        bb->AppendWithEndian(num_key, endian);
-        #endif
+        if constexpr (Options::int_encoding == IntEncoding::Compact) {
+            SplitInt64(num_key, bb);
+        } else {
+            bb->AppendWithEndian((uint8_t)ST_INT, endian);
+            bb->AppendWithEndian(num_key, endian);
+        }
 
     } else if (key_type == ST_FLOAT) {
         auto num_key = cext_to_float(state, key);
@@ -424,7 +1865,8 @@ tl::expected<mrb_value, OSSPErrorInfo> OSSP::AddHashKey(ByteBuffer* bb, mrb_stat
     return {};
 }
 
-serialized_type OSSP::GetType(mrb_value data) {
+template <typename Options>
+serialized_type BasicOSSP<Options>::GetType(mrb_value data) {
     if (mrb_nil_p(data)) {
         return ST_NIL;
     }
@@ -442,7 +1884,8 @@ serialized_type OSSP::GetType(mrb_value data) {
     }
 }
 
-serialized_type OSSP::SplitInt64(int64_t value, ByteBuffer* bb) {
+template <typename Options>
+serialized_type BasicOSSP<Options>::SplitInt64(int64_t value, ByteBuffer* bb) {
     if (bb == nullptr) {
         return ST_INVALID;
     }
@@ -461,7 +1904,8 @@ serialized_type OSSP::SplitInt64(int64_t value, ByteBuffer* bb) {
     return st;
 }
 
-serialized_type OSSP::GetMinBytes(int64_t value) {
+template <typename Options>
+serialized_type BasicOSSP<Options>::GetMinBytes(int64_t value) {
     // invert for negative numbers
     uint64_t bits = (value < 0) ? ~value : value;
 
@@ -508,4 +1952,37 @@ serialized_type OSSP::GetMinBytes(int64_t value) {
     return ST_ADV_BYTE_8;
 }
 
+EncoderProfile::EncoderProfile(uint64_t features) : m_features(features & SUPPORTED_FEATURES) {}
+
+EncoderProfile EncoderProfile::Negotiate(uint64_t local_features, uint64_t remote_features, uint64_t wanted) {
+    return EncoderProfile(local_features & remote_features & wanted);
+}
+
+uint64_t EncoderProfile::Features() const {
+    return m_features;
+}
+
+void EncoderProfile::Serialize(ByteBuffer* bb, mrb_state* mrb, mrb_value data, const std::string& meta_data,
+                               const EncodeOptions& options) const {
+    dispatch_OSSP_features(m_features, [&](auto features) {
+        BasicOSSP<decltype(features)>::Serialize(bb, mrb, data, meta_data, options);
+    });
+}
+
+tl::expected<mrb_value, OSSPErrorInfo> EncoderProfile::Deserialize(ReadBuffer* rb, mrb_state* mrb,
+                                                                   const DecodeOptions& options) const {
+    return dispatch_OSSP_features(m_features, [&](auto features) {
+        return BasicOSSP<decltype(features)>::Deserialize(rb, mrb, options);
+    });
+}
+
+template class BasicOSSP<FeatureOptions<0>>;
+template class BasicOSSP<FeatureOptions<FEATURE_COMPACT_INT>>;
+template class BasicOSSP<FeatureOptions<FEATURE_NATIVE_ENDIAN>>;
+template class BasicOSSP<FeatureOptions<FEATURE_CHECKSUM>>;
+template class BasicOSSP<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN>>;
+template class BasicOSSP<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_CHECKSUM>>;
+template class BasicOSSP<FeatureOptions<FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM>>;
+template class BasicOSSP<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM>>;
+
 }
\ No newline at end of file
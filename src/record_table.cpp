@@ -0,0 +1,124 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/record_table.h"
+
+#include "ossp/help.h"
+#include <string>
+
+namespace lyniat::ossp::serialize::bin {
+
+static uint64_t SizeBit(size_t size) {
+    return 1ULL << (size < 63 ? size : 63);
+}
+
+RecordTable::RecordTable(mrb_state* mrb) : m_mrb(mrb) {}
+
+RecordTable::~RecordTable() {
+    for (auto& record : m_records) {
+        mrb_gc_unregister(m_mrb, mrb_obj_value(record.record_class));
+    }
+}
+
+void RecordTable::Register(mrb_state* mrb, RClass* record_class, const std::vector<mrb_sym>& keys) {
+    Record record = {record_class, keys, {}};
+    record.ivars.reserve(keys.size());
+    for (auto key : keys) {
+        mrb_int len;
+        auto name = mrb_sym_name_len(mrb, key, &len);
+        std::string ivar = "@" + std::string(name, len);
+        record.ivars.push_back(mrb_intern(mrb, ivar.data(), ivar.size()));
+    }
+    mrb_gc_register(mrb, mrb_obj_value(record_class));
+    m_records.push_back(std::move(record));
+    m_sizes |= SizeBit(keys.size());
+}
+
+bool RecordTable::MayMatch(size_t size) const {
+    return (m_sizes & SizeBit(size)) != 0;
+}
+
+mrb_value RecordTable::Materialize(mrb_state* mrb, const mrb_value* entries, size_t size) const {
+    for (auto& record : m_records) {
+        if (record.keys.size() != size) {
+            continue;
+        }
+        // decoded data may repeat a key, which leaves another slot empty and fits no record
+        std::vector<size_t> slots(size);
+        std::vector<bool> filled(size, false);
+        bool matches = true;
+        for (size_t i = 0; i < size && matches; i++) {
+            auto key = entries[i * 2];
+            if (!mrb_symbol_p(key)) {
+                return mrb_nil_value();
+            }
+            slots[i] = FindSlot(record, mrb_symbol(key), i);
+            if (slots[i] == size) {
+                matches = false;
+            } else if (filled[slots[i]]) {
+                return mrb_nil_value();
+            } else {
+                filled[slots[i]] = true;
+            }
+        }
+        if (!matches) {
+            continue;
+        }
+
+        auto object = mrb_obj_value(mrb_obj_alloc(mrb, MRB_TT_OBJECT, record.record_class));
+        for (size_t i = 0; i < size; i++) {
+            mrb_iv_set(mrb, object, record.ivars[slots[i]], entries[i * 2 + 1]);
+        }
+        return object;
+    }
+    return mrb_nil_value();
+}
+
+const RecordTable::Record* RecordTable::Find(mrb_value obj) const {
+    if (mrb_type(obj) != MRB_TT_OBJECT) {
+        return nullptr;
+    }
+    auto object_class = mrb_obj_ptr(obj)->c;
+    for (auto& record : m_records) {
+        if (record.record_class == object_class) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+size_t RecordTable::FindSlot(const Record& record, mrb_sym key, size_t hint) {
+    // encoded Hashes usually keep the order of the record
+    if (hint < record.keys.size() && record.keys[hint] == key) {
+        return hint;
+    }
+    for (size_t i = 0; i < record.keys.size(); i++) {
+        if (record.keys[i] == key) {
+            return i;
+        }
+    }
+    return record.keys.size();
+}
+
+}
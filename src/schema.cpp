@@ -0,0 +1,72 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/schema.h"
+
+#include <cstring>
+
+namespace lyniat::ossp::serialize::bin {
+
+using SchemaFraming = BasicOSSP<FeatureOptions<FEATURE_NATIVE_ENDIAN>>;
+
+void SchemaMessage::Begin(ByteBuffer* bb, uint32_t schema_id) {
+    bb->AppendWithEndian(LE_MAGIC_NUMBER, header_endian);
+    bb->AppendWithEndian(EOD_POSITION, header_endian);
+    bb->AppendWithEndian(features, header_endian);
+    bb->AppendWithEndian(schema_id, endian);
+}
+
+void SchemaMessage::Finish(ByteBuffer* bb, const std::string& meta_data) {
+    bb->SetAtWithEndian(sizeof(LE_MAGIC_NUMBER), (uint32_t)bb->Size(), header_endian);
+    if (!meta_data.empty()) {
+        bb->Append(END_OF_DATA, strlen(END_OF_DATA));
+        bb->AppendString(meta_data);
+    }
+    bb->Append(END_OF_FILE, strlen(END_OF_FILE));
+}
+
+tl::expected<SpanReader, OSSPErrorInfo> SchemaMessage::Open(ReadBuffer* rb, uint32_t schema_id) {
+    SpanReader sr(rb);
+    auto header = SchemaFraming::ReadHeader(&sr, SUPPORTED_FEATURES | FEATURE_SCHEMA);
+    if (!header) {
+        return tl::unexpected(header.error());
+    }
+    if (header->flags != features) {
+        return make_OSSP_error(OSSPUnsupportedFeaturesError, header->data_position);
+    }
+    auto data_sr = SchemaFraming::DataReader(sr, header.value());
+    if (!data_sr) {
+        return data_sr;
+    }
+    uint32_t id;
+    if (!data_sr->ReadWithEndian(&id, endian)) {
+        return make_OSSP_error(OSSPReadingError, data_sr->CurrentReadingPos());
+    }
+    if (id != schema_id) {
+        return make_OSSP_error(OSSPSchemaMismatchError, header->data_position);
+    }
+    return data_sr;
+}
+
+}
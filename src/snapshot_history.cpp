@@ -0,0 +1,143 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "ossp/snapshot_history.h"
+
+#include <cstring>
+
+namespace lyniat::ossp::serialize::bin {
+
+// serial number arithmetic, so comparisons keep working after seq wrapped around
+static bool is_newer(uint32_t seq, uint32_t than) {
+    return (int32_t)(seq - than) > 0;
+}
+
+static bool same_bytes(const ByteBuffer* a, const ByteBuffer* b) {
+    return a->Size() == b->Size() && memcmp(a->DataAt(0), b->DataAt(0), a->Size()) == 0;
+}
+
+SnapshotHistory::SnapshotHistory(uint64_t features, size_t capacity) :
+    m_features(features & SUPPORTED_FEATURES), m_entries(capacity > 0 ? capacity : 1) {}
+
+tl::expected<SnapshotInfo, OSSPErrorInfo> SnapshotHistory::Encode(ByteBuffer* bb, mrb_state* mrb, mrb_value data,
+                                                                  const std::string& meta_data,
+                                                                  const EncodeOptions& options) {
+    auto seq = m_next_seq;
+    auto full = std::make_shared<ByteBuffer>();
+    dispatch_OSSP_features(m_features, [&](auto features) {
+        BasicOSSP<decltype(features)>::Serialize(full.get(), mrb, data, meta_data, options);
+    });
+    auto previous = Find(seq - 1);
+    if (previous != nullptr && same_bytes(previous, full.get())) {
+        full = Slot(seq - 1)->bytes;
+    }
+
+    SnapshotInfo info = {seq, false, 0};
+    ByteBuffer patch;
+    auto baseline = m_has_baseline ? Find(m_baseline) : nullptr;
+    if (baseline != nullptr) {
+        auto encoded = dispatch_OSSP_features(m_features, [&](auto features) {
+            return BasicOSSP<decltype(features)>::EncodeDelta(&patch, baseline, mrb, data, meta_data, options);
+        });
+        if (!encoded) {
+            return tl::unexpected(encoded.error());
+        }
+        info.delta = patch.Size() < full->Size();
+        info.baseline = m_baseline;
+    }
+    auto message = info.delta ? &patch : full.get();
+    bb->Append((char*)message->DataAt(0), message->Size());
+
+    auto slot = Slot(seq);
+    // the ring came around to the baseline, so the peer has fallen too far behind
+    if (m_has_baseline && slot->bytes != nullptr && slot->seq == m_baseline) {
+        m_has_baseline = false;
+    }
+    slot->seq = seq;
+    slot->bytes = full;
+    m_next_seq++;
+    return info;
+}
+
+bool SnapshotHistory::Ack(uint32_t seq) {
+    if (Find(seq) == nullptr || (m_has_baseline && !is_newer(seq, m_baseline))) {
+        return false;
+    }
+    m_has_baseline = true;
+    m_baseline = seq;
+    for (auto& entry : m_entries) {
+        if (entry.bytes != nullptr && is_newer(seq, entry.seq)) {
+            entry.bytes = nullptr;
+        }
+    }
+    return true;
+}
+
+ByteBuffer* SnapshotHistory::Find(uint32_t seq) const {
+    auto& entry = m_entries[seq % m_entries.size()];
+    if (entry.bytes == nullptr || entry.seq != seq) {
+        return nullptr;
+    }
+    return entry.bytes.get();
+}
+
+bool SnapshotHistory::HasBaseline() const {
+    return m_has_baseline;
+}
+
+uint32_t SnapshotHistory::Baseline() const {
+    return m_baseline;
+}
+
+uint32_t SnapshotHistory::NextSeq() const {
+    return m_next_seq;
+}
+
+size_t SnapshotHistory::Size() const {
+    size_t size = 0;
+    for (auto& entry : m_entries) {
+        if (entry.bytes != nullptr) {
+            size++;
+        }
+    }
+    return size;
+}
+
+uint64_t SnapshotHistory::Features() const {
+    return m_features;
+}
+
+void SnapshotHistory::Reset() {
+    for (auto& entry : m_entries) {
+        entry.bytes = nullptr;
+    }
+    m_has_baseline = false;
+}
+
+SnapshotHistory::Entry* SnapshotHistory::Slot(uint32_t seq) {
+    return &m_entries[seq % m_entries.size()];
+}
+
+}
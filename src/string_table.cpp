@@ -0,0 +1,75 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/string_table.h"
+
+#include "ossp/help.h"
+#include <cstring>
+
+namespace lyniat::ossp::serialize::bin {
+
+StringTable::StringTable(mrb_state* mrb, size_t capacity, size_t max_length) :
+    m_mrb(mrb), m_capacity(capacity > 0 ? capacity : 1), m_max_length(max_length) {
+    m_slots = mrb_ary_new_capa(mrb, m_capacity);
+    mrb_gc_register(mrb, m_slots);
+    Clear();
+}
+
+StringTable::~StringTable() {
+    mrb_gc_unregister(m_mrb, m_slots);
+}
+
+mrb_value StringTable::Get(mrb_state* mrb, const char* str, size_t len) {
+    if (len > m_max_length) {
+        return mrb_str_new(mrb, str, len);
+    }
+
+    auto slot = (mrb_int)(Hash(str, len) % m_capacity);
+    auto cached = RARRAY_PTR(m_slots)[slot];
+    if (mrb_string_p(cached) && (size_t)RSTRING_LEN(cached) == len && memcmp(RSTRING_PTR(cached), str, len) == 0) {
+        return cached;
+    }
+
+    auto interned = mrb_obj_freeze(mrb, mrb_str_new(mrb, str, len));
+    mrb_ary_set(mrb, m_slots, slot, interned);
+    return interned;
+}
+
+void StringTable::Clear() {
+    for (size_t i = 0; i < m_capacity; i++) {
+        mrb_ary_set(m_mrb, m_slots, (mrb_int)i, mrb_nil_value());
+    }
+}
+
+size_t StringTable::Hash(const char* str, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+}
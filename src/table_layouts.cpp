@@ -0,0 +1,84 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/table_layouts.h"
+
+#include "ossp/help.h"
+#include <string>
+
+namespace lyniat::ossp::serialize::bin {
+
+static uint64_t SizeBit(size_t size) {
+    return 1ULL << (size < 63 ? size : 63);
+}
+
+uint32_t TableLayouts::Register(mrb_state* mrb, const std::vector<mrb_sym>& keys) {
+    // short Symbols are unpacked into a shared buffer, so every name needs its own copy
+    std::vector<std::string> names;
+    names.reserve(keys.size());
+    for (auto key : keys) {
+        mrb_int len;
+        auto name = mrb_sym_name_len(mrb, key, &len);
+        names.emplace_back(name, len);
+    }
+    auto id = LayoutId(std::vector<std::string_view>(names.begin(), names.end()));
+    m_layouts.push_back({id, keys});
+    m_sizes |= SizeBit(keys.size());
+    return id;
+}
+
+const TableLayouts::Layout* TableLayouts::Find(mrb_state* mrb, mrb_value hash) const {
+    auto size = (size_t)mrb_hash_size(mrb, hash);
+    if ((m_sizes & SizeBit(size)) == 0) {
+        return nullptr;
+    }
+    for (auto& layout : m_layouts) {
+        if (layout.keys.size() != size) {
+            continue;
+        }
+        // keys of a Hash are unique, so finding every key of the layout means the sets are equal
+        bool matches = true;
+        for (size_t i = 0; i < size && matches; i++) {
+            matches = mrb_hash_key_p(mrb, hash, mrb_symbol_value(layout.keys[i]));
+        }
+        if (matches) {
+            return &layout;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t TableLayouts::LayoutId(const std::vector<std::string_view>& names) {
+    uint32_t hash = 2166136261u;
+    for (auto name : names) {
+        for (auto c : name) {
+            hash = (hash ^ (uint8_t)c) * 16777619u;
+        }
+        // separator, so [:ab, :c] and [:a, :bc] differ
+        hash = (hash ^ 0xFF) * 16777619u;
+    }
+    return hash;
+}
+
+}
@@ -0,0 +1,536 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "ossp/tracked.h"
+
+#include "ossp/help.h"
+
+namespace lyniat::ossp::serialize::bin {
+
+// deeper nesting can not be encoded anyway, this only stops converting cyclic data
+static constexpr size_t max_convert_depth = 128;
+
+static void free_tracked(mrb_state* mrb, void* ptr) {
+    delete (TrackedContainer*)ptr;
+}
+
+static const mrb_data_type tracked_hash_type = {"TrackedHash", free_tracked};
+static const mrb_data_type tracked_array_type = {"TrackedArray", free_tracked};
+
+// not valid instance variable names, so Ruby code can not reach them
+static const char* const data_name = "ossp_data";
+static const char* const keys_name = "ossp_keys";
+
+// Interned once per call from Ruby and passed down, a write needs them for itself and each parent.
+// Symbols belong to their mrb_state, so they are not kept anywhere else.
+struct TrackedSymbols {
+    explicit TrackedSymbols(mrb_state* mrb) :
+        data(mrb_intern_cstr(mrb, data_name)),
+        slots(mrb_intern_cstr(mrb, "ossp_slots")),
+        keys(mrb_intern_cstr(mrb, keys_name)),
+        parent(mrb_intern_cstr(mrb, "ossp_parent")) {}
+
+    mrb_sym data;
+    mrb_sym slots;
+    mrb_sym keys;
+    mrb_sym parent;
+};
+
+static void set_bit(std::vector<uint64_t>& bits, size_t slot) {
+    if (bits.size() <= slot / 64) {
+        bits.resize(slot / 64 + 1, 0);
+    }
+    bits[slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+static bool any_bit(const std::vector<uint64_t>& bits) {
+    for (auto word : bits) {
+        if (word != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static TrackedContainer* self_tracked(mrb_state* mrb, mrb_value self) {
+    auto tracked = (TrackedContainer*)DATA_PTR(self);
+    if (tracked == nullptr) {
+        mrb_raise(mrb, E_RUNTIME_ERROR, "uninitialized tracked container");
+    }
+    return tracked;
+}
+
+static RClass* tracked_class(mrb_state* mrb, bool hash) {
+    auto module = mrb_module_get(mrb, "OSSP");
+    return mrb_class_get_under(mrb, module, hash ? tracked_hash_type.struct_name : tracked_array_type.struct_name);
+}
+
+static mrb_value slot_key(mrb_state* mrb, mrb_sym keys_sym, mrb_value tracked, size_t slot) {
+    auto keys = mrb_iv_get(mrb, tracked, keys_sym);
+    if (slot >= (size_t)RARRAY_LEN(keys)) {
+        return mrb_nil_value();
+    }
+    return RARRAY_PTR(keys)[slot];
+}
+
+static void init_tracked(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value self, bool hash) {
+    free_tracked(mrb, DATA_PTR(self));
+    DATA_PTR(self) = nullptr;
+    DATA_TYPE(self) = hash ? &tracked_hash_type : &tracked_array_type;
+    if (hash) {
+        mrb_iv_set(mrb, self, symbols.data, mrb_hash_new(mrb));
+        mrb_iv_set(mrb, self, symbols.slots, mrb_hash_new(mrb));
+        mrb_iv_set(mrb, self, symbols.keys, mrb_ary_new_capa(mrb, 0));
+    } else {
+        mrb_iv_set(mrb, self, symbols.data, mrb_ary_new_capa(mrb, 0));
+    }
+    DATA_PTR(self) = new TrackedContainer{hash, {}, {}, 0, 0, {}};
+}
+
+static mrb_value slot_value(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value tracked,
+                            const TrackedContainer* container, size_t slot) {
+    auto data = mrb_iv_get(mrb, tracked, symbols.data);
+    if (container->hash) {
+        return mrb_hash_get(mrb, data, slot_key(mrb, symbols.keys, tracked, slot));
+    }
+    if (slot >= (size_t)RARRAY_LEN(data)) {
+        return mrb_nil_value();
+    }
+    return RARRAY_PTR(data)[slot];
+}
+
+static bool same_object(mrb_value a, mrb_value b) {
+    return mrb_data_p(a) && mrb_data_p(b) && mrb_ptr(a) == mrb_ptr(b);
+}
+
+// lets the containers above self know that there are changes below them
+static void touch(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value self, const TrackedContainer* container) {
+    while (true) {
+        auto parent = mrb_iv_get(mrb, self, symbols.parent);
+        auto parent_container = get_OSSP_tracked(parent);
+        // the path above is marked already
+        if (parent_container == nullptr || test_OSSP_slot(parent_container->children, container->parent_slot)) {
+            return;
+        }
+        // self might have been replaced or removed in the meantime
+        if (!same_object(slot_value(mrb, symbols, parent, parent_container, container->parent_slot), self)) {
+            return;
+        }
+        set_bit(parent_container->children, container->parent_slot);
+        self = parent;
+        container = parent_container;
+    }
+}
+
+static void mark(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value self, TrackedContainer* container,
+                 size_t slot) {
+    set_bit(container->dirty, slot);
+    touch(mrb, symbols, self, container);
+}
+
+static mrb_value convert(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value value, size_t depth);
+
+// stores value in slot and makes self its parent if it is tracked
+static mrb_value adopt(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value self, size_t slot, mrb_value value,
+                       size_t depth) {
+    value = convert(mrb, symbols, value, depth + 1);
+    auto child = get_OSSP_tracked(value);
+    if (child != nullptr) {
+        mrb_iv_set(mrb, value, symbols.parent, self);
+        child->parent_slot = slot;
+    }
+    return value;
+}
+
+static size_t hash_slot(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value self, mrb_value key) {
+    auto slots = mrb_iv_get(mrb, self, symbols.slots);
+    auto slot = mrb_hash_get(mrb, slots, key);
+    if (!mrb_nil_p(slot)) {
+        return (size_t)cext_to_int(mrb, slot);
+    }
+    // a key that was removed gets its old slot back when it is stored again before the next clear
+    if (mrb_string_p(key) && !MRB_FROZEN_P(mrb_obj_ptr(key))) {
+        key = mrb_obj_freeze(mrb, mrb_str_new(mrb, RSTRING_PTR(key), RSTRING_LEN(key)));
+    }
+    auto container = self_tracked(mrb, self);
+    auto keys = mrb_iv_get(mrb, self, symbols.keys);
+    size_t index = RARRAY_LEN(keys);
+    if (!container->free_slots.empty()) {
+        index = container->free_slots.back();
+        container->free_slots.pop_back();
+        mrb_ary_set(mrb, keys, (mrb_int)index, key);
+    } else {
+        mrb_ary_push(mrb, keys, key);
+    }
+    mrb_hash_set(mrb, slots, key, mrb_int_value(mrb, (mrb_int)index));
+    return index;
+}
+
+// the Delete of a key was encoded, so its slot can go to the next new key
+static void release_slot(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value self, TrackedContainer* container,
+                         size_t slot) {
+    auto key = slot_key(mrb, symbols.keys, self, slot);
+    if (mrb_hash_key_p(mrb, mrb_iv_get(mrb, self, symbols.data), key)) {
+        return;
+    }
+    mrb_hash_delete_key(mrb, mrb_iv_get(mrb, self, symbols.slots), key);
+    mrb_ary_set(mrb, mrb_iv_get(mrb, self, symbols.keys), (mrb_int)slot, mrb_nil_value());
+    container->free_slots.push_back(slot);
+}
+
+static size_t hash_store(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value self, mrb_value key, mrb_value value,
+                         size_t depth) {
+    auto slot = hash_slot(mrb, symbols, self, key);
+    mrb_hash_set(mrb, mrb_iv_get(mrb, self, symbols.data), key, adopt(mrb, symbols, self, slot, value, depth));
+    return slot;
+}
+
+static void array_store(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value self, size_t index, mrb_value value,
+                        size_t depth) {
+    auto data = mrb_iv_get(mrb, self, symbols.data);
+    mrb_ary_set(mrb, data, (mrb_int)index, adopt(mrb, symbols, self, index, value, depth));
+}
+
+// turns Hashes and Arrays into tracked containers, everything else is kept
+static mrb_value convert(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value value, size_t depth) {
+    if (!mrb_hash_p(value) && !mrb_array_p(value)) {
+        return value;
+    }
+    if (depth > max_convert_depth) {
+        mrb_raise(mrb, E_ARGUMENT_ERROR, "nesting too deep to track");
+    }
+    auto hash = mrb_hash_p(value);
+    auto object = mrb_obj_value(mrb_data_object_alloc(mrb, tracked_class(mrb, hash), nullptr, nullptr));
+    init_tracked(mrb, symbols, object, hash);
+    if (hash) {
+        auto keys = mrb_hash_keys(mrb, value);
+        for (mrb_int i = 0; i < RARRAY_LEN(keys); i++) {
+            auto key = RARRAY_PTR(keys)[i];
+            hash_store(mrb, symbols, object, key, mrb_hash_get(mrb, value, key), depth);
+        }
+    } else {
+        for (mrb_int i = 0; i < RARRAY_LEN(value); i++) {
+            array_store(mrb, symbols, object, (size_t)i, RARRAY_PTR(value)[i], depth);
+        }
+        self_tracked(mrb, object)->synced_size = RARRAY_LEN(value);
+    }
+    return object;
+}
+
+// a plain copy with nested tracked containers converted back
+static mrb_value plain(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value value) {
+    auto container = get_OSSP_tracked(value);
+    if (container == nullptr) {
+        return value;
+    }
+    auto data = mrb_iv_get(mrb, value, symbols.data);
+    if (container->hash) {
+        auto result = mrb_hash_new(mrb);
+        auto keys = mrb_hash_keys(mrb, data);
+        for (mrb_int i = 0; i < RARRAY_LEN(keys); i++) {
+            auto key = RARRAY_PTR(keys)[i];
+            mrb_hash_set(mrb, result, key, plain(mrb, symbols, mrb_hash_get(mrb, data, key)));
+        }
+        return result;
+    }
+    auto result = mrb_ary_new_capa(mrb, RARRAY_LEN(data));
+    for (mrb_int i = 0; i < RARRAY_LEN(data); i++) {
+        mrb_ary_set(mrb, result, i, plain(mrb, symbols, RARRAY_PTR(data)[i]));
+    }
+    return result;
+}
+
+static mrb_value tracked_changed(mrb_state* mrb, mrb_value self) {
+    auto container = self_tracked(mrb, self);
+    auto changed = any_bit(container->dirty) || any_bit(container->children);
+    if (!container->hash) {
+        changed = changed || container->synced_size != (size_t)RARRAY_LEN(get_OSSP_tracked_data(mrb, self));
+    }
+    return mrb_bool_value(changed);
+}
+
+static mrb_value tracked_size(mrb_state* mrb, mrb_value self) {
+    auto data = get_OSSP_tracked_data(mrb, self);
+    if (self_tracked(mrb, self)->hash) {
+        return mrb_int_value(mrb, mrb_hash_size(mrb, data));
+    }
+    return mrb_int_value(mrb, RARRAY_LEN(data));
+}
+
+static mrb_value tracked_plain(mrb_state* mrb, mrb_value self) {
+    self_tracked(mrb, self);
+    return plain(mrb, TrackedSymbols(mrb), self);
+}
+
+static mrb_value tracked_hash_initialize(mrb_state* mrb, mrb_value self) {
+    mrb_value source = mrb_nil_value();
+    mrb_get_args(mrb, "|H", &source);
+    TrackedSymbols symbols(mrb);
+    init_tracked(mrb, symbols, self, true);
+    if (mrb_hash_p(source)) {
+        auto keys = mrb_hash_keys(mrb, source);
+        for (mrb_int i = 0; i < RARRAY_LEN(keys); i++) {
+            auto key = RARRAY_PTR(keys)[i];
+            hash_store(mrb, symbols, self, key, mrb_hash_get(mrb, source, key), 0);
+        }
+    }
+    return self;
+}
+
+static mrb_value tracked_hash_get(mrb_state* mrb, mrb_value self) {
+    mrb_value key;
+    mrb_get_args(mrb, "o", &key);
+    self_tracked(mrb, self);
+    return mrb_hash_get(mrb, get_OSSP_tracked_data(mrb, self), key);
+}
+
+static mrb_value tracked_hash_set(mrb_state* mrb, mrb_value self) {
+    mrb_value key;
+    mrb_value value;
+    mrb_get_args(mrb, "oo", &key, &value);
+    auto container = self_tracked(mrb, self);
+    TrackedSymbols symbols(mrb);
+    mark(mrb, symbols, self, container, hash_store(mrb, symbols, self, key, value, 0));
+    return value;
+}
+
+static mrb_value tracked_hash_delete(mrb_state* mrb, mrb_value self) {
+    mrb_value key;
+    mrb_get_args(mrb, "o", &key);
+    auto container = self_tracked(mrb, self);
+    TrackedSymbols symbols(mrb);
+    auto data = mrb_iv_get(mrb, self, symbols.data);
+    if (!mrb_hash_key_p(mrb, data, key)) {
+        return mrb_nil_value();
+    }
+    auto value = mrb_hash_delete_key(mrb, data, key);
+    mark(mrb, symbols, self, container, hash_slot(mrb, symbols, self, key));
+    return value;
+}
+
+static mrb_value tracked_hash_key_p(mrb_state* mrb, mrb_value self) {
+    mrb_value key;
+    mrb_get_args(mrb, "o", &key);
+    self_tracked(mrb, self);
+    return mrb_bool_value(mrb_hash_key_p(mrb, get_OSSP_tracked_data(mrb, self), key));
+}
+
+static mrb_value tracked_hash_keys(mrb_state* mrb, mrb_value self) {
+    self_tracked(mrb, self);
+    return mrb_hash_keys(mrb, get_OSSP_tracked_data(mrb, self));
+}
+
+static mrb_value tracked_hash_each(mrb_state* mrb, mrb_value self) {
+    mrb_value block;
+    mrb_get_args(mrb, "&!", &block);
+    self_tracked(mrb, self);
+    auto data = get_OSSP_tracked_data(mrb, self);
+    // the block may change the Hash, so this walks over a copy of its keys
+    auto keys = mrb_hash_keys(mrb, data);
+    for (mrb_int i = 0; i < RARRAY_LEN(keys); i++) {
+        auto pair = mrb_ary_new_capa(mrb, 2);
+        mrb_ary_set(mrb, pair, 0, RARRAY_PTR(keys)[i]);
+        mrb_ary_set(mrb, pair, 1, mrb_hash_get(mrb, data, RARRAY_PTR(keys)[i]));
+        mrb_yield(mrb, block, pair);
+    }
+    return self;
+}
+
+static size_t checked_index(mrb_state* mrb, mrb_value data, mrb_int index) {
+    if (index < 0) {
+        index += RARRAY_LEN(data);
+    }
+    if (index < 0) {
+        mrb_raise(mrb, E_INDEX_ERROR, "index out of range");
+    }
+    return (size_t)index;
+}
+
+static mrb_value tracked_array_initialize(mrb_state* mrb, mrb_value self) {
+    mrb_value source = mrb_nil_value();
+    mrb_get_args(mrb, "|o", &source);
+    TrackedSymbols symbols(mrb);
+    init_tracked(mrb, symbols, self, false);
+    auto container = self_tracked(mrb, self);
+    if (mrb_array_p(source)) {
+        for (mrb_int i = 0; i < RARRAY_LEN(source); i++) {
+            array_store(mrb, symbols, self, (size_t)i, RARRAY_PTR(source)[i], 0);
+        }
+    } else if (!mrb_nil_p(source)) {
+        auto size = cext_to_int(mrb, source);
+        if (size < 0) {
+            mrb_raise(mrb, E_ARGUMENT_ERROR, "negative array size");
+        }
+        mrb_ary_resize(mrb, mrb_iv_get(mrb, self, symbols.data), size);
+    }
+    container->synced_size = RARRAY_LEN(mrb_iv_get(mrb, self, symbols.data));
+    return self;
+}
+
+static mrb_value tracked_array_get(mrb_state* mrb, mrb_value self) {
+    mrb_int index;
+    mrb_get_args(mrb, "i", &index);
+    self_tracked(mrb, self);
+    auto data = get_OSSP_tracked_data(mrb, self);
+    if (index < 0) {
+        index += RARRAY_LEN(data);
+    }
+    if (index < 0 || index >= RARRAY_LEN(data)) {
+        return mrb_nil_value();
+    }
+    return RARRAY_PTR(data)[index];
+}
+
+static mrb_value tracked_array_set(mrb_state* mrb, mrb_value self) {
+    mrb_int index;
+    mrb_value value;
+    mrb_get_args(mrb, "io", &index, &value);
+    auto container = self_tracked(mrb, self);
+    TrackedSymbols symbols(mrb);
+    auto slot = checked_index(mrb, mrb_iv_get(mrb, self, symbols.data), index);
+    array_store(mrb, symbols, self, slot, value, 0);
+    mark(mrb, symbols, self, container, slot);
+    return value;
+}
+
+static mrb_value tracked_array_push(mrb_state* mrb, mrb_value self) {
+    const mrb_value* values;
+    mrb_int count;
+    mrb_get_args(mrb, "*", &values, &count);
+    auto container = self_tracked(mrb, self);
+    TrackedSymbols symbols(mrb);
+    for (mrb_int i = 0; i < count; i++) {
+        auto slot = (size_t)RARRAY_LEN(mrb_iv_get(mrb, self, symbols.data));
+        array_store(mrb, symbols, self, slot, values[i], 0);
+        mark(mrb, symbols, self, container, slot);
+    }
+    return self;
+}
+
+static mrb_value tracked_array_pop(mrb_state* mrb, mrb_value self) {
+    auto container = self_tracked(mrb, self);
+    TrackedSymbols symbols(mrb);
+    auto data = mrb_iv_get(mrb, self, symbols.data);
+    if (RARRAY_LEN(data) == 0) {
+        return mrb_nil_value();
+    }
+    auto value = mrb_ary_pop(mrb, data);
+    // the new size is sent, the slot itself does not exist anymore
+    touch(mrb, symbols, self, container);
+    return value;
+}
+
+static mrb_value tracked_array_each(mrb_state* mrb, mrb_value self) {
+    mrb_value block;
+    mrb_get_args(mrb, "&!", &block);
+    self_tracked(mrb, self);
+    auto data = get_OSSP_tracked_data(mrb, self);
+    for (mrb_int i = 0; i < RARRAY_LEN(data); i++) {
+        mrb_yield(mrb, block, RARRAY_PTR(data)[i]);
+    }
+    return self;
+}
+
+void define_OSSP_tracked(mrb_state* mrb) {
+    auto module = mrb_define_module(mrb, "OSSP");
+
+    auto tracked_hash = mrb_define_class_under(mrb, module, tracked_hash_type.struct_name, mrb->object_class);
+    MRB_SET_INSTANCE_TT(tracked_hash, MRB_TT_DATA);
+    mrb_define_method(mrb, tracked_hash, "initialize", tracked_hash_initialize, MRB_ARGS_OPT(1));
+    mrb_define_method(mrb, tracked_hash, "[]", tracked_hash_get, MRB_ARGS_REQ(1));
+    mrb_define_method(mrb, tracked_hash, "[]=", tracked_hash_set, MRB_ARGS_REQ(2));
+    mrb_define_method(mrb, tracked_hash, "delete", tracked_hash_delete, MRB_ARGS_REQ(1));
+    mrb_define_method(mrb, tracked_hash, "key?", tracked_hash_key_p, MRB_ARGS_REQ(1));
+    mrb_define_method(mrb, tracked_hash, "keys", tracked_hash_keys, MRB_ARGS_NONE());
+    mrb_define_method(mrb, tracked_hash, "size", tracked_size, MRB_ARGS_NONE());
+    mrb_define_method(mrb, tracked_hash, "each", tracked_hash_each, MRB_ARGS_BLOCK());
+    mrb_define_method(mrb, tracked_hash, "to_h", tracked_plain, MRB_ARGS_NONE());
+    mrb_define_method(mrb, tracked_hash, "changed?", tracked_changed, MRB_ARGS_NONE());
+
+    auto tracked_array = mrb_define_class_under(mrb, module, tracked_array_type.struct_name, mrb->object_class);
+    MRB_SET_INSTANCE_TT(tracked_array, MRB_TT_DATA);
+    mrb_define_method(mrb, tracked_array, "initialize", tracked_array_initialize, MRB_ARGS_OPT(1));
+    mrb_define_method(mrb, tracked_array, "[]", tracked_array_get, MRB_ARGS_REQ(1));
+    mrb_define_method(mrb, tracked_array, "[]=", tracked_array_set, MRB_ARGS_REQ(2));
+    mrb_define_method(mrb, tracked_array, "push", tracked_array_push, MRB_ARGS_ANY());
+    mrb_define_method(mrb, tracked_array, "<<", tracked_array_push, MRB_ARGS_REQ(1));
+    mrb_define_method(mrb, tracked_array, "pop", tracked_array_pop, MRB_ARGS_NONE());
+    mrb_define_method(mrb, tracked_array, "size", tracked_size, MRB_ARGS_NONE());
+    mrb_define_method(mrb, tracked_array, "each", tracked_array_each, MRB_ARGS_BLOCK());
+    mrb_define_method(mrb, tracked_array, "to_a", tracked_plain, MRB_ARGS_NONE());
+    mrb_define_method(mrb, tracked_array, "changed?", tracked_changed, MRB_ARGS_NONE());
+}
+
+TrackedContainer* get_OSSP_tracked(mrb_value value) {
+    if (!mrb_data_p(value)) {
+        return nullptr;
+    }
+    if (DATA_TYPE(value) != &tracked_hash_type && DATA_TYPE(value) != &tracked_array_type) {
+        return nullptr;
+    }
+    return (TrackedContainer*)DATA_PTR(value);
+}
+
+mrb_value get_OSSP_tracked_data(mrb_state* mrb, mrb_value tracked) {
+    return mrb_iv_get(mrb, tracked, mrb_intern_cstr(mrb, data_name));
+}
+
+mrb_value get_OSSP_tracked_key(mrb_state* mrb, mrb_value tracked, size_t slot) {
+    return slot_key(mrb, mrb_intern_cstr(mrb, keys_name), tracked, slot);
+}
+
+static void clear_tracked(mrb_state* mrb, const TrackedSymbols& symbols, mrb_value tracked) {
+    auto container = get_OSSP_tracked(tracked);
+    if (container == nullptr) {
+        return;
+    }
+    std::vector<uint64_t> dirty;
+    std::vector<uint64_t> children;
+    dirty.swap(container->dirty);
+    children.swap(container->children);
+    if (!container->hash) {
+        container->synced_size = RARRAY_LEN(mrb_iv_get(mrb, tracked, symbols.data));
+    }
+    // only containers below changed slots can have changes
+    auto clear_slot = [&](size_t slot) {
+        auto value = slot_value(mrb, symbols, tracked, container, slot);
+        if (get_OSSP_tracked(value) != nullptr) {
+            clear_tracked(mrb, symbols, value);
+        }
+    };
+    for_each_OSSP_slot(dirty, clear_slot);
+    for_each_OSSP_slot(children, clear_slot);
+    // every deleted key was written since the last clear
+    if (container->hash) {
+        for_each_OSSP_slot(dirty, [&](size_t slot) { release_slot(mrb, symbols, tracked, container, slot); });
+    }
+}
+
+
+void clear_OSSP_tracked(mrb_state* mrb, mrb_value tracked) {
+    clear_tracked(mrb, TrackedSymbols(mrb), tracked);
+}
+
+}
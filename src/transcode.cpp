@@ -0,0 +1,448 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/transcode.h"
+
+#include "ossp/cursor.h"
+#include "ossp/writer.h"
+#include <cstring>
+
+namespace lyniat::ossp::serialize::bin {
+
+static void AppendText(ByteBuffer* bb, std::string_view text) {
+    bb->Append((char*)text.data(), text.size());
+}
+
+template <typename Options>
+static tl::expected<void, OSSPErrorInfo> WriteJSON(const uint8_t* data, size_t size, ByteBuffer* out) {
+    auto cursor = BasicCursor<Options>::Open(data, size);
+    if (!cursor) {
+        return tl::unexpected(cursor.error());
+    }
+    struct Level {
+        bool hash;
+        bool first;
+    };
+    std::array<Level, Options::max_depth + 1> levels;
+    uint16_t depth = 0;
+
+    while (true) {
+        auto value = cursor->Next();
+        if (!value) {
+            return tl::unexpected(value.error());
+        }
+        if (value->event == CursorEvent::End) {
+            if (depth == 0) {
+                return {};
+            }
+            AppendText(out, levels[--depth].hash ? "}" : "]");
+            continue;
+        }
+        if (depth > 0) {
+            auto& level = levels[depth - 1];
+            // in a Hash the comma goes in front of the key
+            if (!level.first && (!level.hash || value->key)) {
+                AppendText(out, ",");
+            }
+            level.first = false;
+        }
+
+        switch (value->event) {
+            case CursorEvent::Nil:
+                AppendText(out, "null");
+                break;
+            case CursorEvent::Bool:
+                AppendText(out, value->boolean ? "true" : "false");
+                break;
+            case CursorEvent::Int:
+            case CursorEvent::Float:
+                if (value->key) {
+                    AppendText(out, "\"");
+                }
+                if (value->event == CursorEvent::Int) {
+                    append_JSON_int(out, value->integer);
+                } else {
+                    append_JSON_float(out, value->number);
+                }
+                if (value->key) {
+                    AppendText(out, "\"");
+                }
+                break;
+            case CursorEvent::String:
+            case CursorEvent::Symbol:
+                if (!is_valid_UTF8(value->string.data(), value->string.size())) {
+                    return make_OSSP_error(OSSPInvalidUTF8Error, value->string.data() - (const char*)data);
+                }
+                append_JSON_string(out, value->string);
+                break;
+            case CursorEvent::BeginHash:
+            case CursorEvent::BeginArray: {
+                bool hash = value->event == CursorEvent::BeginHash;
+                AppendText(out, hash ? "{" : "[");
+                levels[depth++] = {hash, true};
+                break;
+            }
+            case CursorEvent::Float64Array:
+            case CursorEvent::Int64Array: {
+                AppendText(out, "[");
+                SpanReader block(value->block, (size_t)value->size * sizeof(uint64_t));
+                for (uint32_t i = 0; i < value->size; i++) {
+                    if (i > 0) {
+                        AppendText(out, ",");
+                    }
+                    if (value->event == CursorEvent::Float64Array) {
+                        double element;
+                        block.ReadUnchecked(&element, Options::endian);
+                        append_JSON_float(out, element);
+                    } else {
+                        int64_t element;
+                        block.ReadUnchecked(&element, Options::endian);
+                        append_JSON_int(out, element);
+                    }
+                }
+                AppendText(out, "]");
+                break;
+            }
+            default:
+                return make_OSSP_error(OSSPErrorInfoInvalidType, cursor->Position());
+        }
+        if (value->key) {
+            AppendText(out, ":");
+        }
+    }
+}
+
+template <typename Options>
+static tl::expected<void, OSSPErrorInfo> WriteOSSP(JSONReader* reader, ByteBuffer* out, KeyConversion keys,
+                                                   const std::string& meta_data) {
+    BasicWriter<Options> writer(out);
+    uint16_t depth = 0;
+    while (true) {
+        auto value = reader->Next();
+        if (!value) {
+            return tl::unexpected(value.error());
+        }
+        switch (value->event) {
+            case CursorEvent::Nil:
+                writer.Nil();
+                break;
+            case CursorEvent::Bool:
+                writer.Bool(value->boolean);
+                break;
+            case CursorEvent::Int:
+                writer.Int(value->integer);
+                break;
+            case CursorEvent::Float:
+                writer.Float(value->number);
+                break;
+            case CursorEvent::String:
+                if (!is_valid_UTF8(value->string.data(), value->string.size())) {
+                    return make_OSSP_error(OSSPInvalidUTF8Error, reader->Position());
+                }
+                if (!value->key) {
+                    writer.String(value->string);
+                } else if (keys == KeyConversion::Symbolize) {
+                    writer.SymbolKey(value->string);
+                } else {
+                    writer.Key(value->string);
+                }
+                break;
+            case CursorEvent::BeginHash:
+                writer.BeginHash();
+                depth++;
+                break;
+            case CursorEvent::BeginArray:
+                writer.BeginArray();
+                depth++;
+                break;
+            case CursorEvent::End:
+                if (depth == 0) {
+                    // strings longer than st_counter_t or containers with too many entries fail here
+                    return writer.Finish(meta_data);
+                }
+                writer.End();
+                depth--;
+                break;
+            default:
+                return make_OSSP_error(OSSPInvalidJSONError, reader->Position());
+        }
+    }
+}
+
+template <typename Options>
+static tl::expected<void, OSSPErrorInfo> WriteMessagePack(const uint8_t* data, size_t size, ByteBuffer* out) {
+    auto cursor = BasicCursor<Options>::Open(data, size);
+    if (!cursor) {
+        return tl::unexpected(cursor.error());
+    }
+    uint16_t depth = 0;
+
+    while (true) {
+        auto value = cursor->Next();
+        if (!value) {
+            return tl::unexpected(value.error());
+        }
+        switch (value->event) {
+            case CursorEvent::End:
+                if (depth == 0) {
+                    return {};
+                }
+                depth--;
+                break;
+            case CursorEvent::Nil:
+                append_MessagePack_nil(out);
+                break;
+            case CursorEvent::Bool:
+                append_MessagePack_bool(out, value->boolean);
+                break;
+            case CursorEvent::Int:
+                append_MessagePack_int(out, value->integer);
+                break;
+            case CursorEvent::Float:
+                append_MessagePack_float(out, value->number);
+                break;
+            case CursorEvent::String:
+                append_MessagePack_string(out, value->string);
+                break;
+            case CursorEvent::Symbol:
+                append_MessagePack_symbol(out, value->string);
+                break;
+            case CursorEvent::BeginHash:
+                append_MessagePack_map(out, value->size);
+                depth++;
+                break;
+            case CursorEvent::BeginArray:
+                append_MessagePack_array(out, value->size);
+                depth++;
+                break;
+            case CursorEvent::Float64Array:
+            case CursorEvent::Int64Array: {
+                append_MessagePack_array(out, value->size);
+                SpanReader block(value->block, (size_t)value->size * sizeof(uint64_t));
+                for (uint32_t i = 0; i < value->size; i++) {
+                    if (value->event == CursorEvent::Float64Array) {
+                        double element;
+                        block.ReadUnchecked(&element, Options::endian);
+                        append_MessagePack_float(out, element);
+                    } else {
+                        int64_t element;
+                        block.ReadUnchecked(&element, Options::endian);
+                        append_MessagePack_int(out, element);
+                    }
+                }
+                break;
+            }
+            default:
+                return make_OSSP_error(OSSPErrorInfoInvalidType, cursor->Position());
+        }
+    }
+}
+
+template <typename Options>
+static tl::expected<void, OSSPErrorInfo> WriteOSSP(MessagePackReader* reader, ByteBuffer* out, KeyConversion keys,
+                                                   const std::string& meta_data) {
+    BasicWriter<Options> writer(out);
+    while (true) {
+        auto value = reader->Next();
+        if (!value) {
+            return tl::unexpected(value.error());
+        }
+        bool key = value->key;
+        switch (value->event) {
+            case CursorEvent::Int:
+                if (key) {
+                    writer.Key(value->integer);
+                } else {
+                    writer.Int(value->integer);
+                }
+                continue;
+            case CursorEvent::Float:
+                if (key) {
+                    // the writer has no Float keys, they are rare enough to encode here
+                    ByteBuffer encoded;
+                    encoded.AppendWithEndian((uint8_t)ST_FLOAT, Options::endian);
+                    encoded.AppendWithEndian((mrb_float)value->number, Options::endian);
+                    writer.EncodedKey((const uint8_t*)encoded.DataAt(0), encoded.Size());
+                } else {
+                    writer.Float(value->number);
+                }
+                continue;
+            case CursorEvent::String:
+                if (!key) {
+                    writer.String(value->string);
+                } else if (keys == KeyConversion::Symbolize) {
+                    writer.SymbolKey(value->string);
+                } else {
+                    writer.Key(value->string);
+                }
+                continue;
+            case CursorEvent::Symbol:
+                if (!key) {
+                    writer.Symbol(value->string);
+                } else if (keys == KeyConversion::Stringify) {
+                    writer.Key(value->string);
+                } else {
+                    writer.SymbolKey(value->string);
+                }
+                continue;
+            case CursorEvent::End:
+                // sized containers close by themselves, only the top level End is left
+                if (reader->Depth() == 0) {
+                    return writer.Finish(meta_data);
+                }
+                continue;
+            default:
+                break;
+        }
+        if (key) {
+            return make_OSSP_error(OSSPErrorInfoInvalidType, reader->Position());
+        }
+        switch (value->event) {
+            case CursorEvent::Nil:
+                writer.Nil();
+                break;
+            case CursorEvent::Bool:
+                writer.Bool(value->boolean);
+                break;
+            case CursorEvent::BeginHash:
+            case CursorEvent::BeginArray:
+                if (value->size > UINT16_MAX) {
+                    return make_OSSP_error(OSSPInvalidStructureError, reader->Position());
+                }
+                if (value->event == CursorEvent::BeginHash) {
+                    writer.BeginHash((st_counter_t)value->size);
+                } else {
+                    writer.BeginArray((st_counter_t)value->size);
+                }
+                break;
+            default:
+                return make_OSSP_error(OSSPInvalidMessagePackError, reader->Position());
+        }
+    }
+}
+
+tl::expected<void, OSSPErrorInfo> transcode_OSSP_to_JSON(const uint8_t* data, size_t size, ByteBuffer* out) {
+    // the cursor checks the header, the flags are only needed to pick it
+    uint64_t features = 0;
+    auto flags_position = sizeof(LE_MAGIC_NUMBER) + sizeof(EOD_POSITION);
+    if (size >= flags_position) {
+        SpanReader flags(data, size, flags_position);
+        flags.ReadWithEndian(&features, header_endian);
+    }
+    return dispatch_OSSP_features(features, [&](auto options) {
+        return WriteJSON<decltype(options)>(data, size, out);
+    });
+}
+
+tl::expected<void, OSSPErrorInfo> transcode_OSSP_to_JSON(ReadBuffer* rb, ByteBuffer* out) {
+    SpanReader sr(rb);
+    return transcode_OSSP_to_JSON(sr.DataAt(0), sr.Size(), out);
+}
+
+tl::expected<void, OSSPErrorInfo> transcode_JSON_to_OSSP(const uint8_t* data, size_t size, ByteBuffer* out,
+                                                        KeyConversion keys, uint64_t features,
+                                                        const std::string& meta_data) {
+    if ((features & ~SUPPORTED_FEATURES) != 0) {
+        return make_OSSP_error(OSSPUnsupportedFeaturesError, 0);
+    }
+    JSONReader reader(data, size);
+    return dispatch_OSSP_features(features, [&](auto options) {
+        return WriteOSSP<decltype(options)>(&reader, out, keys, meta_data);
+    });
+}
+
+tl::expected<void, OSSPErrorInfo> transcode_JSON_to_OSSP(ReadBuffer* rb, ByteBuffer* out, KeyConversion keys,
+                                                        uint64_t features, const std::string& meta_data) {
+    SpanReader sr(rb);
+    return transcode_JSON_to_OSSP(sr.Current(), sr.Remaining(), out, keys, features, meta_data);
+}
+
+tl::expected<void, OSSPErrorInfo> transcode_OSSP_to_MessagePack(const uint8_t* data, size_t size, ByteBuffer* out) {
+    uint64_t features = 0;
+    auto flags_position = sizeof(LE_MAGIC_NUMBER) + sizeof(EOD_POSITION);
+    if (size >= flags_position) {
+        SpanReader flags(data, size, flags_position);
+        flags.ReadWithEndian(&features, header_endian);
+    }
+    return dispatch_OSSP_features(features, [&](auto options) {
+        return WriteMessagePack<decltype(options)>(data, size, out);
+    });
+}
+
+tl::expected<void, OSSPErrorInfo> transcode_OSSP_to_MessagePack(ReadBuffer* rb, ByteBuffer* out) {
+    SpanReader sr(rb);
+    return transcode_OSSP_to_MessagePack(sr.DataAt(0), sr.Size(), out);
+}
+
+tl::expected<void, OSSPErrorInfo> transcode_MessagePack_to_OSSP(const uint8_t* data, size_t size, ByteBuffer* out,
+                                                               KeyConversion keys, uint64_t features,
+                                                               const std::string& meta_data) {
+    if ((features & ~SUPPORTED_FEATURES) != 0) {
+        return make_OSSP_error(OSSPUnsupportedFeaturesError, 0);
+    }
+    MessagePackReader reader(data, size);
+    auto written = dispatch_OSSP_features(features, [&](auto options) {
+        return WriteOSSP<decltype(options)>(&reader, out, keys, meta_data);
+    });
+    if (written && reader.Position() != size) {
+        // one value, nothing may follow
+        return make_OSSP_error(OSSPInvalidMessagePackError, reader.Position());
+    }
+    return written;
+}
+
+tl::expected<void, OSSPErrorInfo> transcode_MessagePack_to_OSSP(ReadBuffer* rb, ByteBuffer* out, KeyConversion keys,
+                                                               uint64_t features, const std::string& meta_data) {
+    SpanReader sr(rb);
+    return transcode_MessagePack_to_OSSP(sr.Current(), sr.Remaining(), out, keys, features, meta_data);
+}
+
+size_t get_OSSP_message_size(const uint8_t* data, size_t size) {
+    if (size < sizeof(LE_MAGIC_NUMBER) + sizeof(EOD_POSITION)) {
+        return 0;
+    }
+    SpanReader sr(data, size, sizeof(LE_MAGIC_NUMBER));
+    uint32_t eod_position;
+    sr.ReadUnchecked(&eod_position, header_endian);
+    if (eod_position > size) {
+        return 0;
+    }
+    size_t pos = eod_position;
+    auto eof_size = strlen(END_OF_FILE);
+    auto eod_size = strlen(END_OF_DATA);
+    if (size - pos >= eod_size && memcmp(data + pos, END_OF_DATA, eod_size) == 0) {
+        // meta data ends with its terminating zero
+        auto end = (const uint8_t*)memchr(data + pos + eod_size, '\0', size - pos - eod_size);
+        if (end == nullptr) {
+            return 0;
+        }
+        pos = end - data + 1;
+    }
+    if (size - pos < eof_size || memcmp(data + pos, END_OF_FILE, eof_size) != 0) {
+        return 0;
+    }
+    return pos + eof_size;
+}
+
+}
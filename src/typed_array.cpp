@@ -0,0 +1,219 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/typed_array.h"
+
+#include "ossp/help.h"
+#include "ossp/serialize.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace lyniat::ossp::serialize::bin {
+
+static constexpr size_t element_size = 8;
+
+// the byte size must not overflow and a larger array could not be serialized anyway
+static constexpr size_t max_elements =
+    std::min(SIZE_MAX / element_size, (size_t)std::numeric_limits<st_block_counter_t>::max());
+
+static void free_typed_array(mrb_state* mrb, void* ptr) {
+    auto array = (TypedArray*)ptr;
+    if (array != nullptr) {
+        mrb_free(mrb, array->data);
+        mrb_free(mrb, array);
+    }
+}
+
+static const mrb_data_type float64_array_type = {"Float64Array", free_typed_array};
+static const mrb_data_type int64_array_type = {"Int64Array", free_typed_array};
+
+static const mrb_data_type* data_type(TypedArrayType type) {
+    return type == TypedArrayType::Float64 ? &float64_array_type : &int64_array_type;
+}
+
+static RClass* typed_array_class(mrb_state* mrb, TypedArrayType type) {
+    if (!mrb_class_defined(mrb, "OSSP")) {
+        return nullptr;
+    }
+    auto module = mrb_module_get(mrb, "OSSP");
+    auto name = data_type(type)->struct_name;
+    if (!mrb_class_defined_under(mrb, module, name)) {
+        return nullptr;
+    }
+    return mrb_class_get_under(mrb, module, name);
+}
+
+static TypedArray* alloc_typed_array(mrb_state* mrb, TypedArrayType type, size_t size) {
+    if (size > max_elements) {
+        mrb_raise(mrb, E_ARGUMENT_ERROR, "array size too big");
+    }
+    auto array = (TypedArray*)mrb_malloc(mrb, sizeof(TypedArray));
+    array->type = type;
+    array->size = size;
+    array->data = mrb_malloc(mrb, size > 0 ? size * element_size : 1);
+    return array;
+}
+
+static mrb_value get_element(mrb_state* mrb, const TypedArray* array, size_t index) {
+    if (array->type == TypedArrayType::Float64) {
+        return mrb_float_value(mrb, ((double*)array->data)[index]);
+    }
+    return mrb_int_value(mrb, (mrb_int)((int64_t*)array->data)[index]);
+}
+
+static void set_element(mrb_state* mrb, TypedArray* array, size_t index, mrb_value value) {
+    if (array->type == TypedArrayType::Float64) {
+        ((double*)array->data)[index] = cext_to_float(mrb, value);
+    } else {
+        ((int64_t*)array->data)[index] = cext_to_int(mrb, value);
+    }
+}
+
+static TypedArray* self_array(mrb_state* mrb, mrb_value self) {
+    auto array = (TypedArray*)DATA_PTR(self);
+    if (array == nullptr) {
+        mrb_raise(mrb, E_RUNTIME_ERROR, "uninitialized typed array");
+    }
+    return array;
+}
+
+static size_t checked_index(mrb_state* mrb, const TypedArray* array, mrb_int index) {
+    if (index < 0) {
+        index += (mrb_int)array->size;
+    }
+    if (index < 0 || (size_t)index >= array->size) {
+        mrb_raise(mrb, E_INDEX_ERROR, "index out of range");
+    }
+    return (size_t)index;
+}
+
+template <TypedArrayType Type>
+static mrb_value typed_array_initialize(mrb_state* mrb, mrb_value self) {
+    mrb_value source;
+    mrb_get_args(mrb, "o", &source);
+
+    free_typed_array(mrb, DATA_PTR(self));
+    DATA_PTR(self) = nullptr;
+    DATA_TYPE(self) = data_type(Type);
+
+    if (mrb_array_p(source)) {
+        auto array = alloc_typed_array(mrb, Type, RARRAY_LEN(source));
+        DATA_PTR(self) = array;
+        for (size_t i = 0; i < array->size; i++) {
+            set_element(mrb, array, i, RARRAY_PTR(source)[i]);
+        }
+    } else {
+        auto size = cext_to_int(mrb, source);
+        if (size < 0) {
+            mrb_raise(mrb, E_ARGUMENT_ERROR, "negative array size");
+        }
+        auto array = alloc_typed_array(mrb, Type, size);
+        memset(array->data, 0, array->size * element_size);
+        DATA_PTR(self) = array;
+    }
+    return self;
+}
+
+static mrb_value typed_array_get(mrb_state* mrb, mrb_value self) {
+    mrb_int index;
+    mrb_get_args(mrb, "i", &index);
+    auto array = self_array(mrb, self);
+    return get_element(mrb, array, checked_index(mrb, array, index));
+}
+
+static mrb_value typed_array_set(mrb_state* mrb, mrb_value self) {
+    mrb_int index;
+    mrb_value value;
+    mrb_get_args(mrb, "io", &index, &value);
+    auto array = self_array(mrb, self);
+    set_element(mrb, array, checked_index(mrb, array, index), value);
+    return value;
+}
+
+static mrb_value typed_array_size(mrb_state* mrb, mrb_value self) {
+    return mrb_int_value(mrb, (mrb_int)self_array(mrb, self)->size);
+}
+
+static mrb_value typed_array_each(mrb_state* mrb, mrb_value self) {
+    mrb_value block;
+    mrb_get_args(mrb, "&!", &block);
+    auto array = self_array(mrb, self);
+    for (size_t i = 0; i < array->size; i++) {
+        mrb_yield(mrb, block, get_element(mrb, array, i));
+    }
+    return self;
+}
+
+static mrb_value typed_array_to_a(mrb_state* mrb, mrb_value self) {
+    auto array = self_array(mrb, self);
+    auto result = mrb_ary_new_capa(mrb, (mrb_int)array->size);
+    for (size_t i = 0; i < array->size; i++) {
+        mrb_ary_set(mrb, result, (mrb_int)i, get_element(mrb, array, i));
+    }
+    return result;
+}
+
+template <TypedArrayType Type>
+static void define_typed_array(mrb_state* mrb, RClass* module) {
+    auto typed_array = mrb_define_class_under(mrb, module, data_type(Type)->struct_name, mrb->object_class);
+    MRB_SET_INSTANCE_TT(typed_array, MRB_TT_DATA);
+    mrb_define_method(mrb, typed_array, "initialize", typed_array_initialize<Type>, MRB_ARGS_REQ(1));
+    mrb_define_method(mrb, typed_array, "[]", typed_array_get, MRB_ARGS_REQ(1));
+    mrb_define_method(mrb, typed_array, "[]=", typed_array_set, MRB_ARGS_REQ(2));
+    mrb_define_method(mrb, typed_array, "size", typed_array_size, MRB_ARGS_NONE());
+    mrb_define_method(mrb, typed_array, "each", typed_array_each, MRB_ARGS_BLOCK());
+    mrb_define_method(mrb, typed_array, "to_a", typed_array_to_a, MRB_ARGS_NONE());
+}
+
+void define_OSSP_typed_arrays(mrb_state* mrb) {
+    auto module = mrb_define_module(mrb, "OSSP");
+    define_typed_array<TypedArrayType::Float64>(mrb, module);
+    define_typed_array<TypedArrayType::Int64>(mrb, module);
+}
+
+TypedArray* get_OSSP_typed_array(mrb_value value) {
+    if (!mrb_data_p(value)) {
+        return nullptr;
+    }
+    if (DATA_TYPE(value) != &float64_array_type && DATA_TYPE(value) != &int64_array_type) {
+        return nullptr;
+    }
+    return (TypedArray*)DATA_PTR(value);
+}
+
+mrb_value new_OSSP_typed_array(mrb_state* mrb, TypedArrayType type, size_t size, TypedArray** array) {
+    auto typed_array = typed_array_class(mrb, type);
+    if (typed_array == nullptr) {
+        return mrb_nil_value();
+    }
+    // allocate the object first, so the buffer can not leak if allocating it fails
+    auto object = mrb_data_object_alloc(mrb, typed_array, nullptr, data_type(type));
+    *array = alloc_typed_array(mrb, type, size);
+    object->data = *array;
+    return mrb_obj_value(object);
+}
+
+}
@@ -0,0 +1,308 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ossp/writer.h"
+
+#include <cstring>
+
+namespace lyniat::ossp::serialize::bin {
+
+template <typename Options>
+BasicWriter<Options>::BasicWriter(ByteBuffer* bb) : m_bb(bb), m_start(bb->Size()) {
+    m_bb->AppendWithEndian(LE_MAGIC_NUMBER, header_endian);
+    m_bb->AppendWithEndian(EOD_POSITION, header_endian);
+    m_bb->AppendWithEndian(Options::features, header_endian);
+    m_data_pos = m_bb->Size();
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Nil() {
+    if (Expect(false)) {
+        m_bb->AppendWithEndian((uint8_t)ST_NIL, endian);
+        Close();
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Bool(bool value) {
+    if (Expect(false)) {
+        m_bb->AppendWithEndian((uint8_t)(value ? ST_TRUE : ST_FALSE), endian);
+        Close();
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Int(int64_t value) {
+    if (Expect(false)) {
+        if constexpr (Options::int_encoding == IntEncoding::Compact) {
+            BasicOSSP<Options>::SplitInt64(value, m_bb);
+        } else {
+            m_bb->AppendWithEndian((uint8_t)ST_INT, endian);
+            m_bb->AppendWithEndian((mrb_int)value, endian);
+        }
+        Close();
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Float(double value) {
+    if (Expect(false)) {
+        m_bb->AppendWithEndian((uint8_t)ST_FLOAT, endian);
+        m_bb->AppendWithEndian((mrb_float)value, endian);
+        Close();
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::String(std::string_view value) {
+    if (Expect(false)) {
+        AppendCounted(ST_STRING, value);
+        Close();
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Symbol(std::string_view value) {
+    if (Expect(false)) {
+        AppendCounted(ST_SYMBOL, value);
+        Close();
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::BeginHash(st_counter_t size) {
+    if (Expect(false)) {
+        m_bb->AppendWithEndian((uint8_t)ST_HASH, endian);
+        m_bb->AppendWithEndian(size, endian);
+        Push(true, (uint32_t)size * 2);
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::BeginArray(st_counter_t size) {
+    if (Expect(false)) {
+        m_bb->AppendWithEndian((uint8_t)ST_ARRAY, endian);
+        m_bb->AppendWithEndian(size, endian);
+        Push(false, size);
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::BeginHash() {
+    return BeginOpen(ST_HASH);
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::BeginArray() {
+    return BeginOpen(ST_ARRAY);
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::End() {
+    if (m_failed) {
+        return *this;
+    }
+    if (m_depth == 0) {
+        m_failed = true;
+        return *this;
+    }
+    auto& frame = m_frames[m_depth - 1];
+    // a Hash must not end between a key and its value
+    if (!frame.open || (frame.hash && frame.remaining % 2 != 0)) {
+        m_failed = true;
+        return *this;
+    }
+    auto size = frame.hash ? frame.remaining / 2 : frame.remaining;
+    if (size > UINT16_MAX) {
+        m_failed = true;
+        return *this;
+    }
+    m_bb->SetAtWithEndian(frame.size_pos, (st_counter_t)size, endian);
+    m_depth--;
+    Close();
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::BeginOpen(serialized_type type) {
+    if (Expect(false)) {
+        m_bb->AppendWithEndian((uint8_t)type, endian);
+        m_bb->AppendWithEndian((st_counter_t)0, endian);
+        Push(type == ST_HASH, 0, true);
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Float64Array(const double* values, size_t size) {
+    TypedArray array = {TypedArrayType::Float64, size, (void*)values};
+    if (size > UINT32_MAX) {
+        m_failed = true;
+    } else if (Expect(false)) {
+        BasicOSSP<Options>::SerializeTypedArray(m_bb, &array);
+        Close();
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Int64Array(const int64_t* values, size_t size) {
+    TypedArray array = {TypedArrayType::Int64, size, (void*)values};
+    if (size > UINT32_MAX) {
+        m_failed = true;
+    } else if (Expect(false)) {
+        BasicOSSP<Options>::SerializeTypedArray(m_bb, &array);
+        Close();
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Key(std::string_view key) {
+    if (Expect(true)) {
+        AppendCounted(ST_STRING, key);
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::SymbolKey(std::string_view key) {
+    if (Expect(true)) {
+        AppendCounted(ST_SYMBOL, key);
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::Key(int64_t key) {
+    if (Expect(true)) {
+        if constexpr (Options::int_encoding == IntEncoding::Compact) {
+            BasicOSSP<Options>::SplitInt64(key, m_bb);
+        } else {
+            m_bb->AppendWithEndian((uint8_t)ST_INT, endian);
+            m_bb->AppendWithEndian((mrb_int)key, endian);
+        }
+    }
+    return *this;
+}
+
+template <typename Options>
+BasicWriter<Options>& BasicWriter<Options>::EncodedKey(const uint8_t* bytes, size_t size) {
+    if (Expect(true)) {
+        m_bb->Append((char*)bytes, size);
+    }
+    return *this;
+}
+
+template <typename Options>
+tl::expected<void, OSSPErrorInfo> BasicWriter<Options>::Finish(const std::string& meta_data) {
+    if (m_failed || m_depth > 0 || !m_root_written) {
+        return make_OSSP_error(OSSPInvalidStructureError, m_bb->Size());
+    }
+    if constexpr (Options::checksum) {
+        auto checksum = BasicOSSP<Options>::Checksum((const uint8_t*)m_bb->DataAt(m_data_pos),
+                                                     m_bb->Size() - m_data_pos);
+        m_bb->AppendWithEndian(checksum, header_endian);
+    }
+    m_bb->SetAtWithEndian(m_start + sizeof(LE_MAGIC_NUMBER), (uint32_t)(m_bb->Size() - m_start), header_endian);
+
+    if (!meta_data.empty()) {
+        m_bb->Append(END_OF_DATA, strlen(END_OF_DATA));
+        m_bb->AppendString(meta_data);
+    }
+    m_bb->Append(END_OF_FILE, strlen(END_OF_FILE));
+    return {};
+}
+
+template <typename Options>
+bool BasicWriter<Options>::Expect(bool key) {
+    if (m_failed) {
+        return false;
+    }
+    if (m_depth == 0) {
+        m_failed = key || m_root_written;
+        m_root_written = true;
+        return !m_failed;
+    }
+    auto& frame = m_frames[m_depth - 1];
+    // keys come at even positions of the remaining (or for open containers the written) hash entries
+    bool wants_key = frame.hash && frame.remaining % 2 == 0;
+    if (wants_key != key) {
+        m_failed = true;
+        return false;
+    }
+    if (frame.open) {
+        frame.remaining++;
+    } else {
+        frame.remaining--;
+    }
+    return true;
+}
+
+template <typename Options>
+void BasicWriter<Options>::Push(bool hash, uint32_t remaining, bool open) {
+    if (m_depth >= Options::max_depth) {
+        m_failed = true;
+        return;
+    }
+    m_frames[m_depth++] = {remaining, hash, open, m_bb->Size() - sizeof(st_counter_t)};
+    Close();
+}
+
+template <typename Options>
+void BasicWriter<Options>::Close() {
+    while (m_depth > 0 && !m_frames[m_depth - 1].open && m_frames[m_depth - 1].remaining == 0) {
+        m_depth--;
+    }
+}
+
+template <typename Options>
+void BasicWriter<Options>::AppendCounted(serialized_type type, std::string_view value) {
+    if (value.size() > UINT16_MAX) {
+        m_failed = true;
+        return;
+    }
+    m_bb->AppendWithEndian((uint8_t)type, endian);
+    m_bb->AppendWithEndian((st_counter_t)value.size(), endian);
+    m_bb->Append((char*)value.data(), value.size());
+}
+
+template class BasicWriter<FeatureOptions<0>>;
+template class BasicWriter<FeatureOptions<FEATURE_COMPACT_INT>>;
+template class BasicWriter<FeatureOptions<FEATURE_NATIVE_ENDIAN>>;
+template class BasicWriter<FeatureOptions<FEATURE_CHECKSUM>>;
+template class BasicWriter<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN>>;
+template class BasicWriter<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_CHECKSUM>>;
+template class BasicWriter<FeatureOptions<FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM>>;
+template class BasicWriter<FeatureOptions<FEATURE_COMPACT_INT | FEATURE_NATIVE_ENDIAN | FEATURE_CHECKSUM>>;
+
+}
@@ -0,0 +1,120 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/serialize.h"
+#include "ossp/writer.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_15.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+RecordTable* record_table;
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    record_table = new RecordTable(state);
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "register_record", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value record_class;
+                                       mrb_value* keys;
+                                       mrb_int keys_size;
+                                       mrb_get_args(mrb, "C*", &record_class, &keys, &keys_size);
+                                       std::vector<mrb_sym> syms;
+                                       for (mrb_int i = 0; i < keys_size; i++) {
+                                           syms.push_back(mrb_symbol(keys[i]));
+                                       }
+                                       record_table->Register(mrb, mrb_class_ptr(record_class), syms);
+                                       return mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_ANY());
+
+    mrb_define_module_function(state, module, "serialize_records", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value data;
+                                       mrb_get_args(mrb, "o", &data);
+                                       EncodeOptions options;
+                                       options.records = record_table;
+                                       OSSP::Serialize(serialized_data, mrb, data, "", options);
+                                       return mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "deserialize_records", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       DecodeOptions options;
+                                       options.records = record_table;
+                                       auto data = OSSP::Deserialize(serialized_data, mrb, options);
+                                       if (data) {
+                                           return data.value<>();
+                                       }
+                                       auto error = generate_OSSP_error_message(data.error());
+                                       mrb_raise(mrb, E_RUNTIME_ERROR, error.c_str());
+                                       // ReSharper disable once CppDFAUnreachableCode
+                                       return mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    mrb_define_module_function(state, module, "write_duplicate_keys", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       // as many keys as Player, but :hp is missing
+                                       Writer writer(serialized_data);
+                                       writer.BeginHash(4).SymbolKey("id").Int(1).SymbolKey("id").Int(2);
+                                       writer.SymbolKey("name").String("owl").SymbolKey("pos").Nil();
+                                       return mrb_bool_value(writer.Finish().has_value());
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_15);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        delete record_table;
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    delete record_table;
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
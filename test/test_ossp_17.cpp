@@ -0,0 +1,101 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/serialize.h"
+#include "ossp/writer.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_17.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "write_native", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       std::map<std::string, int> scores = {{"fox", 3}, {"raccoon", 10}};
+                                       std::vector<std::optional<double>> samples = {1.5, std::nullopt, -2.0};
+                                       std::unordered_map<int, std::string_view> names = {{1, "a"}};
+                                       Writer writer(serialized_data);
+                                       writer.BeginHash(6)
+                                           .SymbolKey("id").Int(7)
+                                           .SymbolKey("name").Write(std::string_view("raccoon"))
+                                           .SymbolKey("alive").Bool(true)
+                                           .SymbolKey("scores").Write(scores)
+                                           .SymbolKey("samples").Write(samples)
+                                           .SymbolKey("nested").BeginArray(2).Write(names).BeginArray(0);
+                                       auto done = writer.Finish();
+                                       return mrb_bool_value(done.has_value());
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    mrb_define_module_function(state, module, "write_invalid", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       ByteBuffer incomplete;
+                                       Writer incomplete_writer(&incomplete);
+                                       incomplete_writer.BeginArray(2).Int(1);
+
+                                       ByteBuffer misplaced;
+                                       Writer misplaced_writer(&misplaced);
+                                       misplaced_writer.BeginHash(1).Int(1).Int(2);
+
+                                       auto first = incomplete_writer.Finish();
+                                       auto second = misplaced_writer.Finish();
+                                       auto result = mrb_ary_new_capa(mrb, 2);
+                                       mrb_ary_set(mrb, result, 0, mrb_int_value(mrb, first ? -1 : (mrb_int)first.error().type));
+                                       mrb_ary_set(mrb, result, 1, mrb_int_value(mrb, second ? -1 : (mrb_int)second.error().type));
+                                       return result;
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_17);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/cursor.h"
+#include "ossp/serialize.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_18.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+mrb_value cursor_payload(mrb_state* mrb, const CursorValue& value) {
+    switch (value.event) {
+        case CursorEvent::Bool: return mrb_bool_value(value.boolean);
+        case CursorEvent::Int: return mrb_int_value(mrb, value.integer);
+        case CursorEvent::Float: return mrb_float_value(mrb, value.number);
+        case CursorEvent::String:
+        case CursorEvent::Symbol: return mrb_str_new(mrb, value.string.data(), value.string.size());
+        case CursorEvent::BeginHash:
+        case CursorEvent::BeginArray:
+        case CursorEvent::Float64Array:
+        case CursorEvent::Int64Array: return mrb_int_value(mrb, value.size);
+        default: return mrb_nil_value();
+    }
+}
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "cursor_events", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       auto events = mrb_ary_new(mrb);
+                                       auto cursor = Cursor::Open(serialized_data);
+                                       if (!cursor) {
+                                           return mrb_nil_value();
+                                       }
+                                       while (true) {
+                                           auto depth = cursor->Depth();
+                                           auto value = cursor->Next();
+                                           if (!value) {
+                                               return mrb_int_value(mrb, (mrb_int)value.error().type);
+                                           }
+                                           auto event = mrb_ary_new_capa(mrb, 3);
+                                           mrb_ary_push(mrb, event, mrb_int_value(mrb, (mrb_int)value->event));
+                                           mrb_ary_push(mrb, event, mrb_bool_value(value->key));
+                                           mrb_ary_push(mrb, event, cursor_payload(mrb, value.value()));
+                                           mrb_ary_push(mrb, events, event);
+                                           if (value->event == CursorEvent::End && depth == 0) {
+                                               return events;
+                                           }
+                                       }
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    mrb_define_module_function(state, module, "cursor_find", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value* keys;
+                                       mrb_int keys_size;
+                                       mrb_get_args(mrb, "*", &keys, &keys_size);
+                                       auto cursor = Cursor::Open(serialized_data);
+                                       for (mrb_int i = 0; i < keys_size; i++) {
+                                           if (!cursor->EnterHash()) {
+                                               return mrb_nil_value();
+                                           }
+                                           auto found = cursor->FindKey(RSTRING_PTR(keys[i]));
+                                           if (!found || !found.value()) {
+                                               return mrb_nil_value();
+                                           }
+                                       }
+                                       auto value = cursor->Next();
+                                       if (value && value->event == CursorEvent::Float64Array) {
+                                           std::vector<double> elements(value->size);
+                                           cursor->CopyBlock(value.value(), elements.data());
+                                           return mrb_float_value(mrb, elements.back());
+                                       }
+                                       return value ? cursor_payload(mrb, value.value()) : mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_ANY());
+
+    define_OSSP_typed_arrays(state);
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_18);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
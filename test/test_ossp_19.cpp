@@ -0,0 +1,107 @@
+#include "mruby/compile.h"
+#include "ossp/fields.h"
+#include "ossp/help.h"
+#include "ossp/serialize.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_19.cpp.inc"
+
+struct Player {
+    int64_t id = 0;
+    std::string name;
+    std::vector<double> pos;
+    int hp = 0;
+    std::optional<std::string> guild;
+};
+
+struct Match {
+    std::string map;
+    std::vector<Player> players;
+    std::map<std::string, int> scores;
+    std::vector<bool> flags;
+};
+
+OSSP_FIELDS(Player, id, name, pos, hp, guild)
+OSSP_FIELDS(Match, map, players, scores, flags)
+
+using namespace lyniat::ossp::serialize::bin;
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "encode_match", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       Match match;
+                                       match.map = "forest";
+                                       match.players.push_back({1, "raccoon", {1.5, -2.0}, 100, "night"});
+                                       match.players.push_back({2, "fox", {}, 80, std::nullopt});
+                                       match.scores = {{"fox", 3}, {"raccoon", 10}};
+                                       match.flags = {true, false};
+                                       return mrb_bool_value(Encode(match, *serialized_data).has_value());
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    mrb_define_module_function(state, module, "decode_match", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       Match match;
+                                       auto decoded = Decode(*serialized_data, match);
+                                       if (!decoded) {
+                                           return mrb_int_value(mrb, (mrb_int)decoded.error().type);
+                                       }
+                                       delete serialized_data;
+                                       serialized_data = new ByteBuffer();
+                                       return mrb_bool_value(Encode(match, *serialized_data).has_value());
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_19);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/serialize.h"
+#include "match.h"
+#include <fstream>
+#include <sstream>
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_20.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+match_schema::Match create_match() {
+    match_schema::Match match;
+    match.map = "forest";
+    match.round = -3;
+    match.players.push_back({1, "raccoon", {1.5, -2.0}, true, "night", {true, false, true}});
+    match.players.push_back({2, "fox", {}, false, std::nullopt, {}});
+    match.scores = {{1, 2, 3}, {}, {-9000000000}};
+    match.winner = match.players[0];
+    return match;
+}
+
+bool same_player(const match_schema::Player& a, const match_schema::Player& b) {
+    return a.id == b.id && a.name == b.name && a.pos == b.pos && a.alive == b.alive && a.guild == b.guild &&
+           a.flags == b.flags;
+}
+
+bool same_match(const match_schema::Match& a, const match_schema::Match& b) {
+    if (a.map != b.map || a.round != b.round || a.scores != b.scores || a.players.size() != b.players.size() ||
+        a.winner.has_value() != b.winner.has_value()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.players.size(); i++) {
+        if (!same_player(a.players[i], b.players[i])) {
+            return false;
+        }
+    }
+    return !a.winner.has_value() || same_player(*a.winner, *b.winner);
+}
+
+mrb_int error_type(const tl::expected<void, OSSPErrorInfo>& result) {
+    return result ? -1 : (mrb_int)result.error().type;
+}
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    std::ifstream validator_file(SCHEMA_VALIDATOR);
+    std::stringstream validator;
+    validator << validator_file.rdbuf();
+    if (load_code(state, context, validator.str()) != 0) {
+        delete serialized_data;
+        ERR_ENDL("Loading the schema validator failed!")
+    }
+
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "schema_round_trip", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       auto match = create_match();
+                                       ByteBuffer bb;
+                                       auto encoded = match_schema::Encode(match, &bb, "meta");
+                                       match_schema::Match decoded;
+                                       auto result = match_schema::Decode(&bb, decoded);
+                                       return mrb_bool_value(encoded && result && same_match(match, decoded));
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    mrb_define_module_function(state, module, "schema_errors", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       ByteBuffer bb;
+                                       (void)match_schema::Encode(create_match(), &bb);
+
+                                       auto generic = OSSP::Validate(&bb);
+                                       match_schema::Player player;
+                                       auto other_message = match_schema::Decode(&bb, player);
+
+                                       // cut the body but keep a valid trailer
+                                       ByteBuffer body;
+                                       (void)match_schema::EncodeBody(&body, create_match());
+                                       ByteBuffer truncated;
+                                       SchemaMessage::Begin(&truncated, match_schema::Match::schema_id);
+                                       truncated.Append((char*)body.DataAt(0), body.Size() - 3);
+                                       SchemaMessage::Finish(&truncated);
+                                       match_schema::Match decoded;
+                                       auto cut = match_schema::Decode(&truncated, decoded);
+
+                                       // a count can not hold this many bytes
+                                       auto long_name = create_match();
+                                       long_name.players[1].name.assign(70000, 'x');
+                                       ByteBuffer too_long;
+                                       auto encoded = match_schema::Encode(long_name, &too_long);
+
+                                       auto result = mrb_ary_new_capa(mrb, 4);
+                                       mrb_ary_set(mrb, result, 0, mrb_int_value(mrb, error_type(generic)));
+                                       mrb_ary_set(mrb, result, 1, mrb_int_value(mrb, error_type(other_message)));
+                                       mrb_ary_set(mrb, result, 2, mrb_int_value(mrb, error_type(cut)));
+                                       mrb_ary_set(mrb, result, 3, mrb_int_value(mrb, error_type(encoded)));
+                                       return result;
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_20);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
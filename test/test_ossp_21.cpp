@@ -0,0 +1,142 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/cursor.h"
+#include "ossp/serialize.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_21.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+TableLayouts* table_layouts;
+
+mrb_value cursor_payload(mrb_state* mrb, const CursorValue& value) {
+    switch (value.event) {
+        case CursorEvent::Int: return mrb_int_value(mrb, value.integer);
+        case CursorEvent::Float: return mrb_float_value(mrb, value.number);
+        case CursorEvent::String:
+        case CursorEvent::Symbol: return mrb_str_new(mrb, value.string.data(), value.string.size());
+        case CursorEvent::BeginArray: return mrb_int_value(mrb, value.size);
+        default: return mrb_nil_value();
+    }
+}
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    table_layouts = new TableLayouts();
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "register_table", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value* keys;
+                                       mrb_int keys_size;
+                                       mrb_get_args(mrb, "*", &keys, &keys_size);
+                                       std::vector<mrb_sym> syms;
+                                       for (mrb_int i = 0; i < keys_size; i++) {
+                                           syms.push_back(mrb_symbol(keys[i]));
+                                       }
+                                       return mrb_int_value(mrb, table_layouts->Register(mrb, syms));
+                                   }
+                               }, MRB_ARGS_ANY());
+
+    mrb_define_module_function(state, module, "layout_id", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value* names;
+                                       mrb_int names_size;
+                                       mrb_get_args(mrb, "*", &names, &names_size);
+                                       std::vector<std::string_view> views;
+                                       for (mrb_int i = 0; i < names_size; i++) {
+                                           views.emplace_back(RSTRING_PTR(names[i]), RSTRING_LEN(names[i]));
+                                       }
+                                       return mrb_int_value(mrb, TableLayouts::LayoutId(views));
+                                   }
+                               }, MRB_ARGS_ANY());
+
+    mrb_define_module_function(state, module, "serialize_tables", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value data;
+                                       mrb_get_args(mrb, "o", &data);
+                                       EncodeOptions options;
+                                       options.tables = table_layouts;
+                                       OSSP::Serialize(serialized_data, mrb, data, "", options);
+                                       return mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "table_fields", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value indices;
+                                       mrb_get_args(mrb, "A", &indices);
+                                       auto cursor = Cursor::Open(serialized_data);
+                                       auto table = cursor->Next();
+                                       auto result = mrb_ary_new(mrb);
+                                       mrb_ary_push(mrb, result, mrb_int_value(mrb, table->layout));
+                                       for (mrb_int i = 0; i < RARRAY_LEN(indices); i++) {
+                                           auto seeked = cursor->SeekField((uint16_t)mrb_integer(RARRAY_PTR(indices)[i]));
+                                           if (!seeked) {
+                                               mrb_ary_push(mrb, result, mrb_int_value(mrb, (mrb_int)seeked.error().type));
+                                               continue;
+                                           }
+                                           auto key = cursor->Next();
+                                           auto value = cursor->Next();
+                                           auto entry = mrb_ary_new_capa(mrb, 2);
+                                           mrb_ary_push(mrb, entry, cursor_payload(mrb, key.value()));
+                                           mrb_ary_push(mrb, entry, cursor_payload(mrb, value.value()));
+                                           mrb_ary_push(mrb, result, entry);
+                                       }
+                                       return result;
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_21);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        delete table_layouts;
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    delete table_layouts;
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/transcode.h"
+#include "ossp/serialize.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_23.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "to_json", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value data;
+                                       mrb_get_args(mrb, "o", &data);
+                                       ByteBuffer bb;
+                                       JSON::Serialize(&bb, mrb, data);
+                                       return mrb_str_new(mrb, (const char*)bb.DataAt(0), bb.Size());
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "transcode_to_json", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value bytes;
+                                       mrb_get_args(mrb, "S", &bytes);
+                                       ByteBuffer bb;
+                                       auto result = transcode_OSSP_to_JSON((const uint8_t*)RSTRING_PTR(bytes),
+                                                                            RSTRING_LEN(bytes), &bb);
+                                       if (!result) {
+                                           return mrb_int_value(mrb, (mrb_int)result.error().type);
+                                       }
+                                       return mrb_str_new(mrb, (const char*)bb.DataAt(0), bb.Size());
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "transcode_to_ossp", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value text;
+                                       mrb_bool symbolize = false;
+                                       mrb_int features = DefaultOptions::features;
+                                       mrb_get_args(mrb, "S|bi", &text, &symbolize, &features);
+                                       ByteBuffer input;
+                                       input.Append(RSTRING_PTR(text), RSTRING_LEN(text));
+                                       ByteBuffer bb;
+                                       auto keys = symbolize ? KeyConversion::Symbolize : KeyConversion::Keep;
+                                       auto result = transcode_JSON_to_OSSP(&input, &bb, keys, features);
+                                       if (!result) {
+                                           return mrb_int_value(mrb, (mrb_int)result.error().type);
+                                       }
+                                       return mrb_str_new(mrb, (const char*)bb.DataAt(0), bb.Size());
+                                   }
+                               }, MRB_ARGS_ARG(1, 2));
+
+    mrb_define_module_function(state, module, "valid_utf8?", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value text;
+                                       mrb_get_args(mrb, "S", &text);
+                                       return mrb_bool_value(is_valid_UTF8(RSTRING_PTR(text), RSTRING_LEN(text)));
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "message_sizes", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value bytes;
+                                       mrb_get_args(mrb, "S", &bytes);
+                                       auto data = (const uint8_t*)RSTRING_PTR(bytes);
+                                       size_t remaining = RSTRING_LEN(bytes);
+                                       auto sizes = mrb_ary_new(mrb);
+                                       mrb_int count = 0;
+                                       while (remaining > 0) {
+                                           auto size = get_OSSP_message_size(data, remaining);
+                                           mrb_ary_set(mrb, sizes, count++, mrb_int_value(mrb, (mrb_int)size));
+                                           if (size == 0) {
+                                               break;
+                                           }
+                                           data += size;
+                                           remaining -= size;
+                                       }
+                                       return sizes;
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_23);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/transcode.h"
+#include "ossp/serialize.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_25.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "to_msgpack", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value data;
+                                       mrb_get_args(mrb, "o", &data);
+                                       ByteBuffer bb;
+                                       MessagePack::Serialize(&bb, mrb, data);
+                                       return mrb_str_new(mrb, (const char*)bb.DataAt(0), bb.Size());
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "from_msgpack", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value bytes;
+                                       mrb_int keys = 0;
+                                       mrb_get_args(mrb, "S|i", &bytes, &keys);
+                                       ByteBuffer bb;
+                                       bb.Append(RSTRING_PTR(bytes), RSTRING_LEN(bytes));
+                                       DecodeOptions options;
+                                       options.keys = (KeyConversion)keys;
+                                       auto data = MessagePack::Deserialize(&bb, mrb, options);
+                                       if (data) {
+                                           return data.value<>();
+                                       }
+                                       return mrb_int_value(mrb, (mrb_int)data.error().type);
+                                   }
+                               }, MRB_ARGS_ARG(1, 1));
+
+    mrb_define_module_function(state, module, "transcode_to_msgpack", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value bytes;
+                                       mrb_get_args(mrb, "S", &bytes);
+                                       ByteBuffer bb;
+                                       auto result = transcode_OSSP_to_MessagePack((const uint8_t*)RSTRING_PTR(bytes),
+                                                                                   RSTRING_LEN(bytes), &bb);
+                                       if (!result) {
+                                           return mrb_int_value(mrb, (mrb_int)result.error().type);
+                                       }
+                                       return mrb_str_new(mrb, (const char*)bb.DataAt(0), bb.Size());
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "transcode_to_ossp", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value bytes;
+                                       mrb_int keys = 0;
+                                       mrb_int features = DefaultOptions::features;
+                                       mrb_get_args(mrb, "S|ii", &bytes, &keys, &features);
+                                       ByteBuffer input;
+                                       input.Append(RSTRING_PTR(bytes), RSTRING_LEN(bytes));
+                                       ByteBuffer bb;
+                                       auto result = transcode_MessagePack_to_OSSP(&input, &bb, (KeyConversion)keys, features);
+                                       if (!result) {
+                                           return mrb_int_value(mrb, (mrb_int)result.error().type);
+                                       }
+                                       return mrb_str_new(mrb, (const char*)bb.DataAt(0), bb.Size());
+                                   }
+                               }, MRB_ARGS_ARG(1, 2));
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_25);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
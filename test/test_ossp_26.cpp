@@ -0,0 +1,100 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/serialize.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_26.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+EncodeCache* encode_cache;
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    encode_cache = new EncodeCache(state, 64, 2);
+    auto module = mrb_module_get(state, "OSSP");
+    mrb_define_module_function(state, module, "serialize_cached", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value data;
+                                       mrb_bool compact = false;
+                                       mrb_get_args(mrb, "o|b", &data, &compact);
+                                       EncodeOptions options;
+                                       options.cache = encode_cache;
+                                       if (compact) {
+                                           BasicOSSP<CompactOptions>::Serialize(serialized_data, mrb, data, "", options);
+                                       } else {
+                                           OSSP::Serialize(serialized_data, mrb, data, "", options);
+                                       }
+                                       return mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_ARG(1, 1));
+
+    mrb_define_module_function(state, module, "cache_stats", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value stats[] = {mrb_int_value(mrb, (mrb_int)encode_cache->Size()),
+                                                            mrb_int_value(mrb, (mrb_int)encode_cache->Hits()),
+                                                            mrb_int_value(mrb, (mrb_int)encode_cache->Misses())};
+                                       return mrb_ary_new_from_values(mrb, 3, stats);
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    mrb_define_module_function(state, module, "cache_sweep", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       encode_cache->Sweep();
+                                       return mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_26);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        delete encode_cache;
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    delete encode_cache;
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/serialize.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_29.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    auto module = mrb_module_get(state, "OSSP");
+    define_OSSP_tracked(state);
+    mrb_define_module_function(state, module, "encode_changes", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value tracked;
+                                       mrb_get_args(mrb, "o", &tracked);
+                                       OSSP::EncodeChanges(serialized_data, mrb, tracked);
+                                       return mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "encode_delta", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value baseline;
+                                       mrb_value current;
+                                       mrb_get_args(mrb, "So", &baseline, &current);
+                                       ByteBuffer buffer;
+                                       buffer.Append(RSTRING_PTR(baseline), RSTRING_LEN(baseline));
+                                       auto result = BasicOSSP<CompactOptions>::EncodeDelta(serialized_data, &buffer, mrb, current);
+                                       if (!result) {
+                                           auto error = generate_OSSP_error_message(result.error());
+                                           mrb_raise(mrb, E_RUNTIME_ERROR, error.c_str());
+                                       }
+                                       return mrb_nil_value();
+                                   }
+                               }, MRB_ARGS_REQ(2));
+
+    mrb_define_module_function(state, module, "apply_patch", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value target;
+                                       mrb_value patch;
+                                       mrb_bool symbolize = false;
+                                       mrb_get_args(mrb, "oS|b", &target, &patch, &symbolize);
+                                       ByteBuffer buffer;
+                                       buffer.Append(RSTRING_PTR(patch), RSTRING_LEN(patch));
+                                       DecodeOptions options;
+                                       if (symbolize) {
+                                           options.keys = KeyConversion::Symbolize;
+                                       }
+                                       auto result = OSSP::ApplyPatch(&buffer, mrb, target, options);
+                                       if (!result) {
+                                           return mrb_int_value(mrb, (mrb_int)result.error().type);
+                                       }
+                                       return result.value<>();
+                                   }
+                               }, MRB_ARGS_ARG(2, 1));
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_29);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
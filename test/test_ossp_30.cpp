@@ -0,0 +1,123 @@
+#include "mruby/compile.h"
+#include "ossp/help.h"
+#include "ossp/serialize.h"
+#include "ossp/snapshot_history.h"
+
+ByteBuffer* serialized_data;
+
+#include "test_data.cpp.inc"
+#include "create_tests.cpp.inc"
+#include "memory_validation.cpp.inc"
+
+#include "test_data_30.cpp.inc"
+
+using namespace lyniat::ossp::serialize::bin;
+
+SnapshotHistory* history;
+
+int run_test() {
+    serialized_data = new ByteBuffer();
+
+    auto state = mrb_open_allocf(debug_allocf, nullptr);
+    auto context = mrbc_context_new(state);
+
+    auto result = create_test_data(state, context);
+    if (result != 0) {
+        FREE_MRB
+        delete serialized_data;
+        ERR_ENDL("Creating test data failed!")
+    }
+
+    auto module = mrb_module_get(state, "OSSP");
+    history = new SnapshotHistory(DefaultOptions::features, 8);
+    mrb_define_module_function(state, module, "history_encode", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value data;
+                                       mrb_get_args(mrb, "o", &data);
+                                       auto info = history->Encode(serialized_data, mrb, data);
+                                       if (!info) {
+                                           auto error = generate_OSSP_error_message(info.error());
+                                           mrb_raise(mrb, E_RUNTIME_ERROR, error.c_str());
+                                       }
+                                       mrb_value result[] = {mrb_int_value(mrb, info->seq), mrb_bool_value(info->delta),
+                                                             mrb_int_value(mrb, info->baseline)};
+                                       return mrb_ary_new_from_values(mrb, 3, result);
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "history_ack", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_int seq;
+                                       mrb_get_args(mrb, "i", &seq);
+                                       return mrb_bool_value(history->Ack((uint32_t)seq));
+                                   }
+                               }, MRB_ARGS_REQ(1));
+
+    mrb_define_module_function(state, module, "history_stats", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       auto shared = history->Find(history->NextSeq() - 1) ==
+                                                     history->Find(history->NextSeq() - 2);
+                                       mrb_value stats[] = {mrb_int_value(mrb, (mrb_int)history->Size()),
+                                                            mrb_bool_value(history->HasBaseline()),
+                                                            mrb_bool_value(shared)};
+                                       return mrb_ary_new_from_values(mrb, 3, stats);
+                                   }
+                               }, MRB_ARGS_NONE());
+
+    mrb_define_module_function(state, module, "apply_patch", {
+                                   [](mrb_state* mrb, mrb_value self) {
+                                       mrb_value target;
+                                       mrb_value patch;
+                                       mrb_bool symbolize = false;
+                                       mrb_get_args(mrb, "oS|b", &target, &patch, &symbolize);
+                                       ByteBuffer buffer;
+                                       buffer.Append(RSTRING_PTR(patch), RSTRING_LEN(patch));
+                                       DecodeOptions options;
+                                       if (symbolize) {
+                                           options.keys = KeyConversion::Symbolize;
+                                       }
+                                       auto result = OSSP::ApplyPatch(&buffer, mrb, target, options);
+                                       if (!result) {
+                                           return mrb_int_value(mrb, (mrb_int)result.error().type);
+                                       }
+                                       return result.value<>();
+                                   }
+                               }, MRB_ARGS_ARG(2, 1));
+
+    load_code(state, context, ruby_test_string);
+    load_code(state, context, ruby_code_30);
+
+    auto test_size_diff = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_size_diff", 0);
+    auto test_int = static_cast<int>(mrb_integer(test_size_diff));
+
+    auto test_result = mrb_funcall(state, mrb_obj_value(state->exc), "get_test_meta", 0);
+    if (!mrb_nil_p(test_result)) {
+        delete history;
+        FREE_MRB
+        delete serialized_data;
+        return 1;
+    }
+
+    delete history;
+    FREE_MRB
+    delete serialized_data;
+    return test_int;
+}
+
+int main() {
+    set_test_memory_allocator();
+
+    auto result = run_test();
+
+    if (result != 0) {
+        return result;
+    }
+
+    auto leaks = check_allocated_memory();
+    if (leaks != 0) {
+        ERR(leaks)
+        ERR_ENDL(" memory leaks detected!")
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+// ossp_float_bench [count]
+//
+// Compares format_float and parse_float with the libc conversions they replace in the text backends:
+// snprintf %.17g and strtod. Values are a mix of game state like floats (positions, ratios) and random
+// bit patterns over the full range. Every result is checked to round trip before timing.
+
+#include "ossp/float_text.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lyniat::ossp::serialize::bin;
+
+namespace {
+
+template <typename F>
+double NanosecondsPer(size_t count, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (double)count;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> positions(-4096.0, 4096.0);
+    std::vector<double> values;
+    values.reserve(count);
+    while (values.size() < count) {
+        if (values.size() % 2 == 0) {
+            values.push_back(positions(rng));
+            continue;
+        }
+        auto bits = rng();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value - value == 0) {
+            values.push_back(value);
+        }
+    }
+
+    std::vector<std::string> texts;
+    texts.reserve(count);
+    char buffer[float_text_max_size];
+    for (auto value : values) {
+        auto end = format_float(value, buffer);
+        double back;
+        auto libc = strtod(std::string(buffer, end).c_str(), nullptr);
+        if (parse_float(buffer, end, &back) != end || back != value || libc != value) {
+            fprintf(stderr, "round trip failed for %.17g\n", value);
+            return 1;
+        }
+        texts.emplace_back(buffer, end);
+    }
+
+    // keeps the optimizer from dropping the loops
+    size_t sink = 0;
+    double sum = 0;
+
+    auto format = NanosecondsPer(count, [&] {
+        for (auto value : values) {
+            sink += format_float(value, buffer) - buffer;
+        }
+    });
+    auto printf_format = NanosecondsPer(count, [&] {
+        for (auto value : values) {
+            sink += snprintf(buffer, sizeof(buffer), "%.17g", value);
+        }
+    });
+    auto parse = NanosecondsPer(count, [&] {
+        for (auto& text : texts) {
+            double value;
+            parse_float(text.data(), text.data() + text.size(), &value);
+            sum += value;
+        }
+    });
+    auto libc_parse = NanosecondsPer(count, [&] {
+        for (auto& text : texts) {
+            sum += strtod(text.c_str(), nullptr);
+        }
+    });
+
+    printf("%zu values\n", count);
+    printf("format  format_float %7.1f ns   snprintf %%.17g %7.1f ns   %5.2fx\n", format, printf_format,
+           printf_format / format);
+    printf("parse   parse_float  %7.1f ns   strtod         %7.1f ns   %5.2fx\n", parse, libc_parse,
+           libc_parse / parse);
+    return sink == 0 && sum == 0 ? 2 : 0;
+}
@@ -0,0 +1,254 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// ossp_json to-json [input [output]]
+// ossp_json to-ossp [--lines] [--symbolize] [--compact] [--native] [--checksum] [input [output]]
+//
+// Converts captured OSSP messages to JSON and back without starting mRuby.
+// to-json reads any number of messages written back to back and writes one JSON line per message.
+// to-ossp reads one JSON value, or with --lines one value per line, and writes one message per value.
+// Input and output default to stdin and stdout, "-" selects them explicitly.
+
+#include "ossp/transcode.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace lyniat::ossp::serialize;
+using namespace lyniat::ossp::serialize::bin;
+
+namespace {
+
+constexpr size_t read_chunk_size = 16 << 20;
+constexpr size_t flush_size = 4 << 20;
+
+// Reads the input in chunks and keeps the bytes of a message that is cut off by the end of a chunk.
+class Input {
+public:
+    explicit Input(FILE* file) : m_file(file) {}
+
+    const uint8_t* Data() const {
+        return m_data.data() + m_pos;
+    }
+
+    size_t Size() const {
+        return m_data.size() - m_pos;
+    }
+
+    bool AtEnd() const {
+        return m_end;
+    }
+
+    void Consume(size_t size) {
+        m_pos += size;
+    }
+
+    // returns false if nothing more can be read
+    bool Fill() {
+        if (m_end) {
+            return false;
+        }
+        m_data.erase(m_data.begin(), m_data.begin() + m_pos);
+        m_pos = 0;
+        auto old_size = m_data.size();
+        m_data.resize(old_size + read_chunk_size);
+        auto read = fread(m_data.data() + old_size, 1, read_chunk_size, m_file);
+        m_data.resize(old_size + read);
+        m_end = read < read_chunk_size;
+        return read > 0 || !m_end;
+    }
+
+private:
+    FILE* m_file;
+    std::vector<uint8_t> m_data;
+    size_t m_pos = 0;
+    bool m_end = false;
+};
+
+class Output {
+public:
+    explicit Output(FILE* file) : m_file(file), m_buffer(std::make_unique<ByteBuffer>()) {}
+
+    ByteBuffer* Buffer() {
+        return m_buffer.get();
+    }
+
+    // writes the buffer once enough has been collected, or always if force is set
+    bool Flush(bool force = false) {
+        if (m_buffer->Size() == 0 || (!force && m_buffer->Size() < flush_size)) {
+            return true;
+        }
+        bool written = fwrite(m_buffer->DataAt(0), 1, m_buffer->Size(), m_file) == m_buffer->Size();
+        m_buffer = std::make_unique<ByteBuffer>();
+        return written;
+    }
+
+private:
+    FILE* m_file;
+    std::unique_ptr<ByteBuffer> m_buffer;
+};
+
+bool IsBlank(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] != ' ' && data[i] != '\n' && data[i] != '\r' && data[i] != '\t') {
+            return false;
+        }
+    }
+    return true;
+}
+
+int Fail(size_t index, const OSSPErrorInfo& error) {
+    std::cerr << "value " << index << ": " << generate_OSSP_error_message(error) << std::endl;
+    return 1;
+}
+
+int ToJSON(Input& input, Output& output) {
+    size_t index = 0;
+    while (true) {
+        auto size = get_OSSP_message_size(input.Data(), input.Size());
+        if (size == 0) {
+            if (input.Fill()) {
+                continue;
+            }
+            if (input.Size() == 0) {
+                return 0;
+            }
+            std::cerr << "value " << index << ": incomplete message at the end of the input" << std::endl;
+            return 1;
+        }
+        auto written = transcode_OSSP_to_JSON(input.Data(), size, output.Buffer());
+        if (!written) {
+            return Fail(index, written.error());
+        }
+        output.Buffer()->Append((char*)"\n", 1);
+        input.Consume(size);
+        index++;
+        if (!output.Flush()) {
+            return 1;
+        }
+    }
+}
+
+int ToOSSP(Input& input, Output& output, bool lines, KeyConversion keys, uint64_t features) {
+    if (!lines) {
+        while (input.Fill()) {}
+        auto written = transcode_JSON_to_OSSP(input.Data(), input.Size(), output.Buffer(), keys, features);
+        return written ? 0 : Fail(0, written.error());
+    }
+
+    size_t index = 0;
+    while (true) {
+        auto end = (const uint8_t*)memchr(input.Data(), '\n', input.Size());
+        if (end == nullptr && input.Fill()) {
+            continue;
+        }
+        size_t size = end == nullptr ? input.Size() : end - input.Data();
+        if (size == 0 && end == nullptr) {
+            return 0;
+        }
+        if (!IsBlank(input.Data(), size)) {
+            auto written = transcode_JSON_to_OSSP(input.Data(), size, output.Buffer(), keys, features);
+            if (!written) {
+                return Fail(index, written.error());
+            }
+            index++;
+        }
+        input.Consume(end == nullptr ? size : size + 1);
+        if (!output.Flush()) {
+            return 1;
+        }
+    }
+}
+
+FILE* OpenFile(const char* path, const char* mode, FILE* standard) {
+    if (path == nullptr || strcmp(path, "-") == 0) {
+        return standard;
+    }
+    return fopen(path, mode);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const char* usage = "usage: ossp_json to-json [input [output]]\n"
+                        "       ossp_json to-ossp [--lines] [--symbolize] [--compact] [--native] [--checksum] "
+                        "[input [output]]";
+    if (argc < 2 || (strcmp(argv[1], "to-json") != 0 && strcmp(argv[1], "to-ossp") != 0)) {
+        std::cerr << usage << std::endl;
+        return 2;
+    }
+    bool to_json = strcmp(argv[1], "to-json") == 0;
+    bool lines = false;
+    auto keys = KeyConversion::Keep;
+    uint64_t features = 0;
+    std::vector<const char*> paths;
+    for (int i = 2; i < argc; i++) {
+        std::string argument = argv[i];
+        if (!to_json && argument == "--lines") {
+            lines = true;
+        } else if (!to_json && argument == "--symbolize") {
+            keys = KeyConversion::Symbolize;
+        } else if (!to_json && argument == "--compact") {
+            features |= FEATURE_COMPACT_INT;
+        } else if (!to_json && argument == "--native") {
+            features |= FEATURE_NATIVE_ENDIAN;
+        } else if (!to_json && argument == "--checksum") {
+            features |= FEATURE_CHECKSUM;
+        } else if ((argument.size() > 1 && argument[0] == '-') || paths.size() == 2) {
+            std::cerr << usage << std::endl;
+            return 2;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    auto in = OpenFile(paths.size() > 0 ? paths[0] : nullptr, "rb", stdin);
+    if (in == nullptr) {
+        std::cerr << paths[0] << ": can not be read" << std::endl;
+        return 1;
+    }
+    auto out = OpenFile(paths.size() > 1 ? paths[1] : nullptr, "wb", stdout);
+    if (out == nullptr) {
+        std::cerr << paths[1] << ": can not be written" << std::endl;
+        return 1;
+    }
+
+    Input input(in);
+    Output output(out);
+    auto result = to_json ? ToJSON(input, output) : ToOSSP(input, output, lines, keys, features);
+    if (!output.Flush(true)) {
+        std::cerr << "output can not be written" << std::endl;
+        result = 1;
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (out != stdout && fclose(out) != 0) {
+        result = 1;
+    }
+    return result;
+}
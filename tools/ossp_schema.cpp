@@ -0,0 +1,805 @@
+/*
+* MIT License
+*
+* Copyright (c) 2025 Laurin "lyniat" Muth
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+*         of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+*         to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*         copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+*         copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*         AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+// ossp_schema <schema file> <output path without extension>
+//
+// Generates <output>.h (C++ structs with Encode/Decode), <output>.rb (validator for Ruby values)
+// and <output>.hexpat (ImHex pattern) from a schema like this:
+//
+//     # comments start with a hash sign
+//     namespace game;
+//
+//     message Player {
+//         id: int;
+//         name: string;
+//         pos: [float];
+//         guild: string?;
+//     }
+//
+//     message Match {
+//         map: symbol;
+//         players: [Player];
+//     }
+//
+// Types are bool, int, float, string, symbol, [T] for arrays, T? for optional values and
+// messages declared above. The generated code writes and reads the untagged layout of
+// SchemaMessage (include/ossp/schema.h).
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class Kind {
+    Bool,
+    Int,
+    Float,
+    String,
+    Symbol,
+    Array,
+    Optional,
+    Message
+};
+
+struct Message;
+
+struct Type {
+    Kind kind;
+    std::shared_ptr<Type> element; // Array and Optional
+    const Message* message = nullptr;
+};
+
+struct Field {
+    std::string name;
+    Type type;
+};
+
+struct Message {
+    std::string name;
+    std::vector<Field> fields;
+};
+
+struct Schema {
+    std::string name_space = "ossp_schema";
+    std::vector<std::unique_ptr<Message>> messages;
+
+    const Message* Find(const std::string& name) const {
+        for (auto& message : messages) {
+            if (message->name == name) {
+                return message.get();
+            }
+        }
+        return nullptr;
+    }
+};
+
+class Parser {
+public:
+    explicit Parser(const std::string& source) : m_source(source) {}
+
+    bool Parse(Schema* schema) {
+        Next();
+        if (m_token == "namespace") {
+            Next();
+            schema->name_space = Identifier("namespace name");
+            Expect(";");
+        }
+        while (m_ok && !m_token.empty()) {
+            if (m_token != "message") {
+                Fail("expected 'message'");
+                break;
+            }
+            Next();
+            auto message = std::make_unique<Message>();
+            message->name = Identifier("message name");
+            if (schema->Find(message->name) != nullptr) {
+                Fail("message " + message->name + " is declared twice");
+            }
+            Expect("{");
+            while (m_ok && m_token != "}") {
+                Field field;
+                field.name = Identifier("field name");
+                for (auto& other : message->fields) {
+                    if (other.name == field.name) {
+                        Fail("field " + field.name + " is declared twice");
+                    }
+                }
+                Expect(":");
+                field.type = ParseType(*schema);
+                if (m_token == ";" || m_token == ",") {
+                    Next();
+                }
+                message->fields.push_back(std::move(field));
+            }
+            Expect("}");
+            if (m_ok && message->fields.empty()) {
+                Fail("message " + message->name + " has no fields");
+            }
+            schema->messages.push_back(std::move(message));
+        }
+        if (m_ok && schema->messages.empty()) {
+            Fail("the schema declares no messages");
+        }
+        return m_ok;
+    }
+
+    const std::string& Error() const {
+        return m_error;
+    }
+
+private:
+    Type ParseType(const Schema& schema) {
+        Type type;
+        if (m_token == "[") {
+            Next();
+            type.kind = Kind::Array;
+            type.element = std::make_shared<Type>(ParseType(schema));
+            Expect("]");
+        } else {
+            auto name = Identifier("type");
+            static const std::map<std::string, Kind> scalars = {
+                {"bool", Kind::Bool}, {"int", Kind::Int}, {"float", Kind::Float},
+                {"string", Kind::String}, {"symbol", Kind::Symbol}};
+            auto scalar = scalars.find(name);
+            if (scalar != scalars.end()) {
+                type.kind = scalar->second;
+            } else {
+                type.kind = Kind::Message;
+                type.message = schema.Find(name);
+                if (type.message == nullptr && m_ok) {
+                    // requiring declaration before use also rules out recursive messages
+                    Fail("unknown type " + name + ", messages have to be declared before they are used");
+                }
+            }
+        }
+        while (m_ok && m_token == "?") {
+            Next();
+            Type optional;
+            optional.kind = Kind::Optional;
+            optional.element = std::make_shared<Type>(type);
+            type = optional;
+        }
+        return type;
+    }
+
+    std::string Identifier(const std::string& what) {
+        if (m_token.empty() || !(isalpha((unsigned char)m_token[0]) || m_token[0] == '_')) {
+            Fail("expected " + what);
+            return "";
+        }
+        auto identifier = m_token;
+        Next();
+        return identifier;
+    }
+
+    void Expect(const std::string& token) {
+        if (m_token != token) {
+            Fail("expected '" + token + "'");
+            return;
+        }
+        Next();
+    }
+
+    void Fail(const std::string& message) {
+        if (m_ok) {
+            m_ok = false;
+            m_error = "line " + std::to_string(m_line) + ": " + message +
+                      (m_token.empty() ? " at end of file" : ", found '" + m_token + "'");
+        }
+        m_token.clear();
+    }
+
+    void Next() {
+        m_token.clear();
+        if (!m_ok) {
+            return;
+        }
+        while (m_pos < m_source.size()) {
+            char c = m_source[m_pos];
+            if (c == '\n') {
+                m_line++;
+                m_pos++;
+            } else if (isspace((unsigned char)c)) {
+                m_pos++;
+            } else if (c == '#') {
+                while (m_pos < m_source.size() && m_source[m_pos] != '\n') {
+                    m_pos++;
+                }
+            } else {
+                break;
+            }
+        }
+        if (m_pos >= m_source.size()) {
+            return;
+        }
+        char c = m_source[m_pos];
+        if (isalnum((unsigned char)c) || c == '_') {
+            while (m_pos < m_source.size() && (isalnum((unsigned char)m_source[m_pos]) || m_source[m_pos] == '_')) {
+                m_token += m_source[m_pos++];
+            }
+        } else {
+            m_token = std::string(1, c);
+            m_pos++;
+        }
+    }
+
+    const std::string& m_source;
+    size_t m_pos = 0;
+    size_t m_line = 1;
+    std::string m_token;
+    bool m_ok = true;
+    std::string m_error;
+};
+
+// Canonical text of a type, nested messages included, so every change of the layout changes the id.
+std::string Signature(const Type& type) {
+    switch (type.kind) {
+        case Kind::Bool: return "bool";
+        case Kind::Int: return "int";
+        case Kind::Float: return "float";
+        case Kind::String: return "string";
+        case Kind::Symbol: return "symbol";
+        case Kind::Array: return "[" + Signature(*type.element) + "]";
+        case Kind::Optional: return Signature(*type.element) + "?";
+        case Kind::Message: {
+            std::string signature = type.message->name + "{";
+            for (auto& field : type.message->fields) {
+                signature += field.name + ":" + Signature(field.type) + ";";
+            }
+            return signature + "}";
+        }
+    }
+    return "";
+}
+
+uint32_t SchemaId(const Message& message) {
+    Type type;
+    type.kind = Kind::Message;
+    type.message = &message;
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (char c : Signature(type)) {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+std::string Hex(uint32_t value) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "0x%08X", value);
+    return buffer;
+}
+
+// bytes that are always present for a field, checked together with the fields around it
+size_t FixedSize(const Type& type) {
+    switch (type.kind) {
+        case Kind::Bool: return 1;
+        case Kind::Int:
+        case Kind::Float: return 8;
+        case Kind::String:
+        case Kind::Symbol:
+        case Kind::Array: return 2;
+        case Kind::Optional: return 1;
+        case Kind::Message: return 0;
+    }
+    return 0;
+}
+
+bool IsScalar(const Type& type) {
+    return type.kind == Kind::Bool || type.kind == Kind::Int || type.kind == Kind::Float;
+}
+
+class CppGenerator {
+public:
+    explicit CppGenerator(const Schema& schema) : m_schema(schema) {}
+
+    std::string Generate(const std::string& source_name) {
+        m_out << "// generated by ossp_schema from " << source_name << ", do not edit\n\n";
+        m_out << "#pragma once\n\n";
+        m_out << "#include <cstdint>\n#include <optional>\n#include <string>\n#include <vector>\n";
+        m_out << "#include \"ossp/schema.h\"\n\n";
+        m_out << "namespace " << m_schema.name_space << " {\n";
+        m_out << "using namespace lyniat::ossp::serialize::bin;\n";
+        m_out << "using lyniat::ossp::serialize::st_counter_t;\n";
+        for (auto& message : m_schema.messages) {
+            GenerateStruct(*message);
+        }
+        for (auto& message : m_schema.messages) {
+            GenerateEncode(*message);
+            GenerateDecode(*message);
+        }
+        m_out << "\n}\n";
+        return m_out.str();
+    }
+
+private:
+    static std::string CppType(const Type& type) {
+        switch (type.kind) {
+            case Kind::Bool: return "bool";
+            case Kind::Int: return "int64_t";
+            case Kind::Float: return "double";
+            case Kind::String:
+            case Kind::Symbol: return "std::string";
+            case Kind::Array: return "std::vector<" + CppType(*type.element) + ">";
+            case Kind::Optional: return "std::optional<" + CppType(*type.element) + ">";
+            case Kind::Message: return type.message->name;
+        }
+        return "";
+    }
+
+    static std::string WireType(const Type& type) {
+        switch (type.kind) {
+            case Kind::Bool: return "uint8_t";
+            case Kind::Int: return "int64_t";
+            case Kind::Float: return "double";
+            default: return "";
+        }
+    }
+
+    void GenerateStruct(const Message& message) {
+        m_out << "\nstruct " << message.name << " {\n";
+        m_out << "    static constexpr uint32_t schema_id = " << Hex(SchemaId(message)) << ";\n\n";
+        for (auto& field : message.fields) {
+            m_out << "    " << CppType(field.type) << " " << field.name;
+            if (IsScalar(field.type)) {
+                m_out << (field.type.kind == Kind::Bool ? " = false" : " = 0");
+            }
+            m_out << ";\n";
+        }
+        m_out << "};\n";
+    }
+
+    void GenerateEncode(const Message& message) {
+        // strings and arrays with more than UINT16_MAX entries do not fit their count and fail like in BasicWriter
+        m_out << "\ninline tl::expected<void, OSSPErrorInfo> EncodeBody(ByteBuffer* bb, const " << message.name
+              << "& value) {\n";
+        for (auto& field : message.fields) {
+            EmitWrite(field.type, "value." + field.name, 1);
+        }
+        m_out << "    return {};\n}\n";
+
+        m_out << "\ninline tl::expected<void, OSSPErrorInfo> Encode(const " << message.name << "& value, ByteBuffer* bb, "
+              << "const std::string& meta_data = \"\") {\n";
+        m_out << "    SchemaMessage::Begin(bb, " << message.name << "::schema_id);\n";
+        m_out << "    auto body = EncodeBody(bb, value);\n";
+        m_out << "    if (!body) {\n        return body;\n    }\n";
+        m_out << "    SchemaMessage::Finish(bb, meta_data);\n";
+        m_out << "    return {};\n}\n";
+    }
+
+    void EmitWrite(const Type& type, const std::string& value, int depth) {
+        auto indent = std::string(depth * 4, ' ');
+        switch (type.kind) {
+            case Kind::Bool:
+            case Kind::Int:
+            case Kind::Float:
+                m_out << indent << "bb->AppendWithEndian((" << WireType(type) << ")" << value
+                      << ", SchemaMessage::endian);\n";
+                break;
+            case Kind::String:
+            case Kind::Symbol:
+                EmitSizeCheck(indent, value);
+                m_out << indent << "bb->AppendWithEndian((st_counter_t)" << value << ".size(), SchemaMessage::endian);\n";
+                m_out << indent << "bb->Append((char*)" << value << ".data(), (st_counter_t)" << value << ".size());\n";
+                break;
+            case Kind::Array: {
+                auto element = "e" + std::to_string(depth);
+                EmitSizeCheck(indent, value);
+                m_out << indent << "bb->AppendWithEndian((st_counter_t)" << value << ".size(), SchemaMessage::endian);\n";
+                m_out << indent << "for (st_counter_t i" << depth << " = 0; i" << depth << " < (st_counter_t)"
+                      << value << ".size(); i" << depth << "++) {\n";
+                m_out << indent << "    const auto& " << element << " = " << value << "[i" << depth << "];\n";
+                EmitWrite(*type.element, element, depth + 1);
+                m_out << indent << "}\n";
+                break;
+            }
+            case Kind::Optional:
+                m_out << indent << "bb->AppendWithEndian((uint8_t)" << value << ".has_value(), SchemaMessage::endian);\n";
+                m_out << indent << "if (" << value << ".has_value()) {\n";
+                EmitWrite(*type.element, "(*" + value + ")", depth + 1);
+                m_out << indent << "}\n";
+                break;
+            case Kind::Message: {
+                auto body = "body" + std::to_string(depth);
+                m_out << indent << "auto " << body << " = EncodeBody(bb, " << value << ");\n";
+                m_out << indent << "if (!" << body << ") {\n" << indent << "    return " << body << ";\n"
+                      << indent << "}\n";
+                break;
+            }
+        }
+    }
+
+    void EmitSizeCheck(const std::string& indent, const std::string& value) {
+        m_out << indent << "if (" << value << ".size() > UINT16_MAX) {\n";
+        m_out << indent << "    return make_OSSP_error(OSSPInvalidStructureError, bb->Size());\n";
+        m_out << indent << "}\n";
+    }
+
+    void GenerateDecode(const Message& message) {
+        m_out << "\ninline bool DecodeBody(SpanReader* sr, " << message.name << "& value) {\n";
+        // Consecutive fields share one bounds check: a run ends with the fixed part of a field
+        // whose remaining size depends on the data.
+        size_t i = 0;
+        auto& fields = message.fields;
+        while (i < fields.size()) {
+            size_t run_end = i;
+            size_t run_size = 0;
+            while (run_end < fields.size()) {
+                run_size += FixedSize(fields[run_end].type);
+                if (!IsScalar(fields[run_end].type)) {
+                    break;
+                }
+                run_end++;
+            }
+            if (run_size > 0) {
+                m_out << "    if (sr->Remaining() < " << run_size << ") {\n        return false;\n    }\n";
+            }
+            for (; i < fields.size() && i <= run_end; i++) {
+                EmitRead(fields[i].type, "value." + fields[i].name, 1, true);
+            }
+        }
+        m_out << "    return true;\n}\n";
+
+        m_out << "\ninline tl::expected<void, OSSPErrorInfo> Decode(ReadBuffer* rb, " << message.name << "& value) {\n";
+        m_out << "    auto sr = SchemaMessage::Open(rb, " << message.name << "::schema_id);\n";
+        m_out << "    if (!sr) {\n        return tl::unexpected(sr.error());\n    }\n";
+        m_out << "    if (!DecodeBody(&sr.value(), value)) {\n";
+        m_out << "        return make_OSSP_error(OSSPReadingError, sr->CurrentReadingPos());\n    }\n";
+        m_out << "    if (sr->Remaining() != 0) {\n";
+        m_out << "        return make_OSSP_error(OSSPUnexpectedDataError, sr->CurrentReadingPos());\n    }\n";
+        m_out << "    return {};\n}\n";
+    }
+
+    // checked means that the fixed part of the value is already known to be available
+    void EmitRead(const Type& type, const std::string& target, int depth, bool checked) {
+        auto indent = std::string(depth * 4, ' ');
+        auto suffix = std::to_string(depth);
+        switch (type.kind) {
+            case Kind::Bool:
+            case Kind::Int:
+            case Kind::Float: {
+                auto wire = WireType(type);
+                m_out << indent << "{\n";
+                m_out << indent << "    " << wire << " raw;\n";
+                if (checked) {
+                    m_out << indent << "    sr->ReadUnchecked(&raw, SchemaMessage::endian);\n";
+                } else {
+                    m_out << indent << "    if (!sr->ReadWithEndian(&raw, SchemaMessage::endian)) {\n";
+                    m_out << indent << "        return false;\n" << indent << "    }\n";
+                }
+                m_out << indent << "    " << target << (type.kind == Kind::Bool ? " = raw != 0;\n" : " = raw;\n");
+                m_out << indent << "}\n";
+                break;
+            }
+            case Kind::String:
+            case Kind::Symbol:
+                m_out << indent << "{\n";
+                EmitCount(indent, checked);
+                m_out << indent << "    if (sr->Remaining() < count) {\n" << indent << "        return false;\n"
+                      << indent << "    }\n";
+                m_out << indent << "    " << target << ".assign((const char*)sr->Current(), count);\n";
+                m_out << indent << "    sr->Skip(count);\n";
+                m_out << indent << "}\n";
+                break;
+            case Kind::Array: {
+                auto& element = *type.element;
+                m_out << indent << "{\n";
+                EmitCount(indent, checked);
+                if (IsScalar(element)) {
+                    // all elements are checked at once
+                    m_out << indent << "    if (sr->Remaining() / " << FixedSize(element) << " < count) {\n"
+                          << indent << "        return false;\n" << indent << "    }\n";
+                } else {
+                    // every element needs at least one byte, which limits the allocation below
+                    m_out << indent << "    if (sr->Remaining() < count * " << std::max<size_t>(FixedSize(element), 1)
+                          << "u) {\n" << indent << "        return false;\n" << indent << "    }\n";
+                }
+                // by index through a local, std::vector<bool> has no references to its elements
+                m_out << indent << "    " << target << ".resize(count);\n";
+                m_out << indent << "    for (size_t i" << suffix << " = 0; i" << suffix << " < count; i" << suffix
+                      << "++) {\n";
+                m_out << indent << "        " << CppType(element) << " e" << suffix << "{};\n";
+                EmitRead(element, "e" + suffix, depth + 2, IsScalar(element));
+                m_out << indent << "        " << target << "[i" << suffix << "] = std::move(e" << suffix << ");\n";
+                m_out << indent << "    }\n";
+                m_out << indent << "}\n";
+                break;
+            }
+            case Kind::Optional: {
+                m_out << indent << "{\n";
+                m_out << indent << "    uint8_t present;\n";
+                if (checked) {
+                    m_out << indent << "    sr->ReadUnchecked(&present, SchemaMessage::endian);\n";
+                } else {
+                    m_out << indent << "    if (!sr->ReadWithEndian(&present, SchemaMessage::endian)) {\n";
+                    m_out << indent << "        return false;\n" << indent << "    }\n";
+                }
+                m_out << indent << "    if (present) {\n";
+                m_out << indent << "        " << CppType(*type.element) << " o" << suffix << "{};\n";
+                EmitRead(*type.element, "o" + suffix, depth + 2, false);
+                m_out << indent << "        " << target << " = std::move(o" << suffix << ");\n";
+                m_out << indent << "    } else {\n";
+                m_out << indent << "        " << target << ".reset();\n";
+                m_out << indent << "    }\n";
+                m_out << indent << "}\n";
+                break;
+            }
+            case Kind::Message:
+                m_out << indent << "if (!DecodeBody(sr, " << target << ")) {\n";
+                m_out << indent << "    return false;\n" << indent << "}\n";
+                break;
+        }
+    }
+
+    void EmitCount(const std::string& indent, bool checked) {
+        m_out << indent << "    st_counter_t count;\n";
+        if (checked) {
+            m_out << indent << "    sr->ReadUnchecked(&count, SchemaMessage::endian);\n";
+        } else {
+            m_out << indent << "    if (!sr->ReadWithEndian(&count, SchemaMessage::endian)) {\n";
+            m_out << indent << "        return false;\n" << indent << "    }\n";
+        }
+    }
+
+    const Schema& m_schema;
+    std::stringstream m_out;
+};
+
+std::string RubyModuleName(const std::string& name_space) {
+    std::string name;
+    bool upper = true;
+    for (char c : name_space) {
+        if (c == '_') {
+            upper = true;
+        } else {
+            name += upper ? (char)toupper((unsigned char)c) : c;
+            upper = false;
+        }
+    }
+    return name;
+}
+
+std::string RubySpec(const Type& type) {
+    switch (type.kind) {
+        case Kind::Bool: return ":bool";
+        case Kind::Int: return ":int";
+        case Kind::Float: return ":float";
+        case Kind::String: return ":string";
+        case Kind::Symbol: return ":symbol";
+        case Kind::Array: return "[:array, " + RubySpec(*type.element) + "]";
+        case Kind::Optional: return "[:optional, " + RubySpec(*type.element) + "]";
+        case Kind::Message: return "[:message, :" + type.message->name + "]";
+    }
+    return "";
+}
+
+std::string GenerateRuby(const Schema& schema, const std::string& source_name) {
+    std::stringstream out;
+    out << "# generated by ossp_schema from " << source_name << ", do not edit\n\n";
+    out << "module " << RubyModuleName(schema.name_space) << "\n";
+    out << "  MESSAGES = {\n";
+    for (auto& message : schema.messages) {
+        out << "    " << message->name << ": {\n";
+        for (auto& field : message->fields) {
+            out << "      " << field.name << ": " << RubySpec(field.type) << ",\n";
+        }
+        out << "    },\n";
+    }
+    out << "  }\n\n";
+    out << R"(  # Returns a list of errors, which is empty if value is a Hash with Symbol keys that
+  # matches the message.
+  def self.validate(message, value)
+    errors = []
+    check([:message, message], value, message.to_s, errors)
+    errors
+  end
+
+  def self.valid?(message, value)
+    validate(message, value).empty?
+  end
+
+  def self.check(spec, value, path, errors)
+    if spec.is_a?(Symbol)
+      valid = case spec
+              when :bool then value == true || value == false
+              when :int then value.is_a?(Integer)
+              when :float then value.is_a?(Float) || value.is_a?(Integer)
+              when :string then value.is_a?(String)
+              when :symbol then value.is_a?(Symbol)
+              end
+      errors << "#{path}: expected #{spec}, got #{value.inspect}" unless valid
+      errors << "#{path}: too long" if valid && (spec == :string || spec == :symbol) && value.to_s.bytesize > 65535
+      return
+    end
+
+    kind, inner = spec
+    case kind
+    when :optional
+      check(inner, value, path, errors) unless value.nil?
+    when :array
+      unless value.is_a?(Array)
+        errors << "#{path}: expected an Array, got #{value.inspect}"
+        return
+      end
+      errors << "#{path}: too many elements" if value.size > 65535
+      value.each_with_index { |element, i| check(inner, element, "#{path}[#{i}]", errors) }
+    when :message
+      unless value.is_a?(Hash)
+        errors << "#{path}: expected a #{inner} Hash, got #{value.inspect}"
+        return
+      end
+      fields = MESSAGES[inner]
+      fields.each do |name, field_spec|
+        if value.key?(name)
+          check(field_spec, value[name], "#{path}.#{name}", errors)
+        elsif !field_spec.is_a?(Array) || field_spec[0] != :optional
+          errors << "#{path}.#{name}: missing"
+        end
+      end
+      value.each_key { |key| errors << "#{path}: unknown key #{key.inspect}" unless fields.key?(key) }
+    end
+  end
+end
+)";
+    return out.str();
+}
+
+class HexpatGenerator {
+public:
+    explicit HexpatGenerator(const Schema& schema) : m_schema(schema) {}
+
+    std::string Generate(const std::string& source_name) {
+        std::stringstream out;
+        out << "// generated by ossp_schema from " << source_name << ", do not edit\n\n";
+        out << "#pragma description OSSP schema messages of " << source_name << "\n\n";
+        out << "#pragma endian little\n";
+        out << "#pragma magic [ 50 53 53 4F ] @ 0x00 //OSSP\n\n";
+        out << "struct SchemaString {\n    u16 len [[hidden]];\n    char value[len];\n} [[name(value)]];\n";
+        for (auto& message : m_schema.messages) {
+            for (auto& field : message->fields) {
+                Declare(field.type);
+            }
+            m_types << "\nstruct " << message->name << " {\n";
+            for (auto& field : message->fields) {
+                m_types << "    " << Name(field.type) << " " << field.name << ";\n";
+            }
+            m_types << "};\n";
+        }
+        out << m_types.str();
+
+        // ImHex needs one root, which is the last message of the schema
+        auto& root = m_schema.messages.back();
+        out << "\nstruct SchemaMessage {\n";
+        out << "    be u32 magic_number;\n    be u32 eod_position;\n    be u64 flags;\n";
+        out << "    u32 schema_id [[color(\"f0dab1\")]];\n";
+        out << "    " << root->name << " message;\n";
+        out << "    char end[3] [[color(\"ff0000\")]];\n};\n\n";
+        out << "SchemaMessage root @ 0x00;\n";
+        return out.str();
+    }
+
+private:
+    static std::string Name(const Type& type) {
+        switch (type.kind) {
+            case Kind::Bool: return "u8";
+            case Kind::Int: return "s64";
+            case Kind::Float: return "double";
+            case Kind::String:
+            case Kind::Symbol: return "SchemaString";
+            case Kind::Array: return "Array_" + Mangle(*type.element);
+            case Kind::Optional: return "Optional_" + Mangle(*type.element);
+            case Kind::Message: return type.message->name;
+        }
+        return "";
+    }
+
+    static std::string Mangle(const Type& type) {
+        switch (type.kind) {
+            case Kind::Bool: return "bool";
+            case Kind::Int: return "int";
+            case Kind::Float: return "float";
+            case Kind::String: return "string";
+            case Kind::Symbol: return "symbol";
+            default: return Name(type);
+        }
+    }
+
+    // emits the wrapper structs of arrays and optional values, inner types first
+    void Declare(const Type& type) {
+        if (type.kind != Kind::Array && type.kind != Kind::Optional) {
+            return;
+        }
+        Declare(*type.element);
+        auto name = Name(type);
+        if (!m_declared.insert({name, true}).second) {
+            return;
+        }
+        m_types << "\nstruct " << name << " {\n";
+        if (type.kind == Kind::Array) {
+            m_types << "    u16 count [[hidden]];\n";
+            m_types << "    " << Name(*type.element) << " elements[count] [[inline]];\n";
+        } else {
+            m_types << "    u8 present [[hidden]];\n";
+            m_types << "    if (present != 0) {\n        " << Name(*type.element) << " value [[inline]];\n    }\n";
+        }
+        m_types << "};\n";
+    }
+
+    const Schema& m_schema;
+    std::stringstream m_types;
+    std::map<std::string, bool> m_declared;
+};
+
+bool WriteFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+    return (bool)file;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: ossp_schema <schema file> <output path without extension>" << std::endl;
+        return 2;
+    }
+    std::string schema_path = argv[1];
+    std::string output = argv[2];
+
+    std::ifstream file(schema_path, std::ios::binary);
+    if (!file) {
+        std::cerr << schema_path << ": can not be read" << std::endl;
+        return 1;
+    }
+    std::stringstream source;
+    source << file.rdbuf();
+    auto text = source.str();
+
+    Schema schema;
+    Parser parser(text);
+    if (!parser.Parse(&schema)) {
+        std::cerr << schema_path << ":" << parser.Error() << std::endl;
+        return 1;
+    }
+
+    auto source_name = schema_path.substr(schema_path.find_last_of("/\\") + 1);
+    bool written = WriteFile(output + ".h", CppGenerator(schema).Generate(source_name)) &&
+                   WriteFile(output + ".rb", GenerateRuby(schema, source_name)) &&
+                   WriteFile(output + ".hexpat", HexpatGenerator(schema).Generate(source_name));
+    if (!written) {
+        std::cerr << output << ": output can not be written" << std::endl;
+        return 1;
+    }
+    return 0;
+}